@@ -5,6 +5,7 @@
 #include "Utils/MolecularCVars.h"
 #include "MolecularTypes.h"
 
+#include <Algo/BinarySearch.h>
 #include <TimerManager.h>
 #include <Engine/World.h>
 
@@ -12,7 +13,7 @@
 #include "MolecularUITags.h"
 #include "Utils/LogMolecularUI.h"
 
-void UMockStoreDataProviderSubsystem::FetchStoreItems(TFunction<void(const TArray<FStoreItem>&, const FText&)> OnSuccess,
+void UMockStoreDataProviderSubsystem::FetchStoreItems(TFunction<void(const TSharedRef<const FStoreCatalogSnapshot>&, const FText&)> OnSuccess,
 											 TFunction<void(const FText&)> OnFailure)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
@@ -22,7 +23,7 @@ void UMockStoreDataProviderSubsystem::FetchStoreItems(TFunction<void(const TArra
 	{
 		auto OnDataCreated = [this, OnSuccess]()
 		{
-			OnSuccess(BackendStoreItems, FText::FromString(TEXT("Store items loaded.")));
+			OnSuccess(GetSnapshot(StoreItemsSnapshot, BackendStoreItems), FText::FromString(TEXT("Store items loaded.")));
 		};
 
 		if (!bDummyStoreDataInitialized)
@@ -41,13 +42,173 @@ void UMockStoreDataProviderSubsystem::FetchStoreItems(TFunction<void(const TArra
 		OnFailure(FText::FromString(TEXT("Failed to load store items.")));
 	};
 
+	// Every call gets its own timer, since restarting a shared one would drop the earlier caller without an answer.
+	FTimerHandle ItemLoadHandle;
 	FETCH_MOCK_DATA(ItemLoadHandle, SuccessWrapper, FailureWrapper,
 					MolecularUI::CVars::Store::FailureChance,
 					MolecularUI::CVars::Store::MinDelay,
 					MolecularUI::CVars::Store::MaxDelay);
 }
 
-void UMockStoreDataProviderSubsystem::FetchOwnedItems(TFunction<void(const TArray<FStoreItem>&, const FText&)> OnSuccess,
+void UMockStoreDataProviderSubsystem::FetchStoreItemsPage(const FString& Cursor, const int32 PageSize,
+												 TFunction<void(FStoreItemPage&&, const FText&)> OnPage,
+												 TFunction<void(const FText&)> OnFailure)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	// The cursor is the offset of the page's first item. Items bought or sold between pages can shift it, which a
+	// real backend would avoid by paging a snapshot or a stable key.
+	int32 FirstItem = 0;
+	if (!Cursor.IsEmpty() && (!LexTryParseString(FirstItem, *Cursor) || FirstItem < 0))
+	{
+		OnFailure(FText::FromString(FString::Printf(TEXT("Invalid store page cursor '%s'."), *Cursor)));
+		return;
+	}
+
+	/*Callback*/
+	auto SuccessWrapper = [this, FirstItem, PageSize, OnPage]()
+	{
+		auto OnDataCreated = [this, FirstItem, PageSize, OnPage]()
+		{
+			const int32 EndItem = FMath::Min(FirstItem + FMath::Max(PageSize, 1), BackendStoreItems.Num());
+			FStoreItemPage Page;
+			Page.Version = BackendVersion;
+			Page.Items.Reserve(FMath::Max(EndItem - FirstItem, 0));
+			for (int32 ItemIndex = FirstItem; ItemIndex < EndItem; ++ItemIndex)
+			{
+				Page.Items.Add(BackendStoreItems[ItemIndex]);
+			}
+			if (EndItem < BackendStoreItems.Num())
+			{
+				Page.NextCursor = LexToString(EndItem);
+			}
+			const bool bLastPage = Page.IsLastPage();
+			OnPage(MoveTemp(Page), FText::FromString(bLastPage ? TEXT("Store items loaded.") : TEXT("Loading store items...")));
+		};
+
+		if (!bDummyStoreDataInitialized)
+		{
+			CreateDummyStoreData(OnDataCreated);
+		}
+		else
+		{
+			OnDataCreated();
+		}
+	};
+
+	/*Callback*/
+	auto FailureWrapper = [OnFailure]()
+	{
+		OnFailure(FText::FromString(TEXT("Failed to load store items.")));
+	};
+
+	// Page requests for different cursors can overlap, like a refresh restarting a paged load. Each one gets its own
+	// timer, since restarting a shared one would drop the request in flight without ever answering it.
+	FTimerHandle PageLoadHandle;
+
+	// The first page pays for the whole request's latency, later pages only for their transfer.
+	if (Cursor.IsEmpty())
+	{
+		FETCH_MOCK_DATA(PageLoadHandle, SuccessWrapper, FailureWrapper,
+						MolecularUI::CVars::Store::FailureChance,
+						MolecularUI::CVars::Store::MinDelay,
+						MolecularUI::CVars::Store::MaxDelay);
+	}
+	else
+	{
+		FETCH_MOCK_DATA(PageLoadHandle, SuccessWrapper, FailureWrapper,
+						MolecularUI::CVars::Store::FailureChance,
+						MolecularUI::CVars::Store::PageMinDelay,
+						MolecularUI::CVars::Store::PageMaxDelay);
+	}
+}
+
+void UMockStoreDataProviderSubsystem::FetchStoreChanges(const int64 SinceVersion,
+											   TFunction<void(FStoreChangeSet&&, const FText&)> OnSuccess,
+											   TFunction<void(const FText&)> OnFailure)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	/*Callback*/
+	auto SuccessWrapper = [this, SinceVersion, OnSuccess]()
+	{
+		FStoreChangeSet Changes;
+		Changes.Version = BackendVersion;
+		if (SinceVersion < OldestLoggedVersion || SinceVersion > BackendVersion)
+		{
+			Changes.bRequiresFullRefresh = true;
+			OnSuccess(MoveTemp(Changes), FText::FromString(TEXT("Store changed, reloading.")));
+			return;
+		}
+
+		// An item changed several times since SinceVersion is sent once, with its current state.
+		TSet<FName> StoreItemIds;
+		TSet<FName> OwnedItemIds;
+		bool bCurrencyChanged = false;
+		for (int32 ChangeIndex = Algo::UpperBoundBy(ChangeLog, SinceVersion, &FMockChange::Version); ChangeIndex < ChangeLog.Num(); ++ChangeIndex)
+		{
+			const FMockChange& Change = ChangeLog[ChangeIndex];
+			switch (Change.List)
+			{
+			case EMockChangeList::Store:
+				StoreItemIds.Add(Change.ItemId);
+				break;
+			case EMockChangeList::Owned:
+				OwnedItemIds.Add(Change.ItemId);
+				break;
+			case EMockChangeList::Currency:
+				bCurrencyChanged = true;
+				break;
+			}
+		}
+
+		for (const FName& ItemId : StoreItemIds)
+		{
+			const FStoreItem* Item = BackendStoreItems.FindByPredicate([&ItemId](const FStoreItem& StoreItem) { return StoreItem.ItemId == ItemId; });
+			if (Item != nullptr)
+			{
+				Changes.StoreUpserts.Add(*Item);
+			}
+			else
+			{
+				Changes.StoreRemovals.Add(ItemId);
+			}
+		}
+		for (const FName& ItemId : OwnedItemIds)
+		{
+			const FStoreItem* Item = BackendOwnedStoreItems.FindByPredicate([&ItemId](const FStoreItem& OwnedItem) { return OwnedItem.ItemId == ItemId; });
+			if (Item != nullptr)
+			{
+				Changes.OwnedUpserts.Add(*Item);
+			}
+			else
+			{
+				Changes.OwnedRemovals.Add(ItemId);
+			}
+		}
+		if (bCurrencyChanged)
+		{
+			Changes.PlayerCurrency = BackendPlayerCurrency;
+		}
+
+		OnSuccess(MoveTemp(Changes), FText::FromString(TEXT("Store changes loaded.")));
+	};
+
+	/*Callback*/
+	auto FailureWrapper = [OnFailure]()
+	{
+		OnFailure(FText::FromString(TEXT("Failed to load store changes.")));
+	};
+
+	// Queries from different versions can overlap too, so each gets its own timer as well.
+	FTimerHandle ChangesLoadHandle;
+	FETCH_MOCK_DATA(ChangesLoadHandle, SuccessWrapper, FailureWrapper,
+					MolecularUI::CVars::Store::FailureChance,
+					MolecularUI::CVars::Store::PageMinDelay,
+					MolecularUI::CVars::Store::PageMaxDelay);
+}
+
+void UMockStoreDataProviderSubsystem::FetchOwnedItems(TFunction<void(const TSharedRef<const FStoreCatalogSnapshot>&, const FText&)> OnSuccess,
 											 TFunction<void(const FText&)> OnFailure)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
@@ -57,7 +218,7 @@ void UMockStoreDataProviderSubsystem::FetchOwnedItems(TFunction<void(const TArra
 	{
 		auto OnDataCreated = [this, OnSuccess]()
 		{
-			OnSuccess(BackendOwnedStoreItems, FText::FromString(TEXT("Owned items loaded.")));
+			OnSuccess(GetSnapshot(OwnedItemsSnapshot, BackendOwnedStoreItems), FText::FromString(TEXT("Owned items loaded.")));
 		};
 
 		if (!bDummyOwnedDataInitialized)
@@ -76,6 +237,7 @@ void UMockStoreDataProviderSubsystem::FetchOwnedItems(TFunction<void(const TArra
 		OnFailure(FText::FromString(TEXT("Failed to load owned items.")));
 	};
 
+	FTimerHandle OwnedItemLoadHandle;
 	FETCH_MOCK_DATA(OwnedItemLoadHandle, SuccessWrapper, FailureWrapper,
 					MolecularUI::CVars::OwnedItems::FailureChance,
 					MolecularUI::CVars::OwnedItems::MinDelay,
@@ -103,6 +265,7 @@ void UMockStoreDataProviderSubsystem::FetchPlayerCurrency(TFunction<void(int32,
 		OnFailure(FText::FromString(TEXT("Failed to load currency.")));
 	};
 
+	FTimerHandle CurrencyLoadHandle;
 	FETCH_MOCK_DATA(CurrencyLoadHandle, SuccessWrapper, FailureWrapper,
 					MolecularUI::CVars::PlayerCurrency::FailureChance,
 					MolecularUI::CVars::PlayerCurrency::MinDelay,
@@ -163,6 +326,7 @@ void UMockStoreDataProviderSubsystem::PurchaseItem(const FTransactionRequest& Re
 			BackendOwnedStoreItems.AddUnique(*Item);
 			BackendStoreItems.RemoveAll([&](const FStoreItem& StoreItem){ return StoreItem.ItemId == Item->ItemId; });
 		}
+		RecordTransaction(Request);
 
 		OnSuccess(FText::FromString(TEXT("Purchase successful.")));
 	};
@@ -173,6 +337,8 @@ void UMockStoreDataProviderSubsystem::PurchaseItem(const FTransactionRequest& Re
 		OnFailure(FText::FromString(TEXT("Purchase failed.")));
 	};
 
+	// Transactions can overlap as well, e.g. two purchases in a row without the multiplexer queueing them.
+	FTimerHandle TransactionHandle;
 	FETCH_MOCK_DATA(TransactionHandle, SuccessWrapper, FailureWrapper,
 					MolecularUI::CVars::Transaction::FailureChance,
 					MolecularUI::CVars::Transaction::MinDelay,
@@ -210,7 +376,7 @@ void UMockStoreDataProviderSubsystem::SellItem(const FTransactionRequest& Reques
 				OnFailure(FText::FromString(ErrorText));
 				return;
 			}
-			Refund += FoundItem->Cost / 2; // Arbitrary refund logic, e.g., 50% of the cost. TODO: Make this configurable.
+			Refund += GetSellRefund(*FoundItem);
 
 			UE_LOG(LogMolecularUI, Log, TEXT("[%hs] Found item %s with cost %d."), __FUNCTION__, *FoundItem->ItemId.ToString(), FoundItem->Cost);
 			ItemsToSell.Add(FoundItem);
@@ -218,12 +384,13 @@ void UMockStoreDataProviderSubsystem::SellItem(const FTransactionRequest& Reques
 
 		for (FStoreItem* Item : ItemsToSell)
 		{
-			UE_LOG(LogMolecularUI, Log, TEXT("[%hs] Simulating sale of item %s with refund %d."), __FUNCTION__, *Item->ItemId.ToString(), Item->Cost / 2);
+			UE_LOG(LogMolecularUI, Log, TEXT("[%hs] Simulating sale of item %s with refund %d."), __FUNCTION__, *Item->ItemId.ToString(), GetSellRefund(*Item));
 			Item->bIsOwned = false;
 			BackendOwnedStoreItems.RemoveAll([&](const FStoreItem& Owned){ return Owned.ItemId == Item->ItemId; });
 			BackendStoreItems.AddUnique(*Item);
 		}
 		BackendPlayerCurrency += Refund;
+		RecordTransaction(Request);
 		OnSuccess(FText::FromString(TEXT("Sale successful.")));
 	};
 
@@ -233,6 +400,7 @@ void UMockStoreDataProviderSubsystem::SellItem(const FTransactionRequest& Reques
 		OnFailure(FText::FromString(TEXT("Sale failed.")));
 	};
 
+	FTimerHandle TransactionHandle;
 	FETCH_MOCK_DATA(TransactionHandle, SuccessWrapper, FailureWrapper,
 					MolecularUI::CVars::Transaction::FailureChance,
 					MolecularUI::CVars::Transaction::MinDelay,
@@ -289,6 +457,7 @@ void UMockStoreDataProviderSubsystem::CreateDummyStoreData(TFunction<void()> OnC
 	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
 
 	BackendStoreItems.Empty();
+	StoreItemsSnapshot.Reset();
 
 	auto OnDataTableLoaded = [this, OnComplete]()
 	{
@@ -336,6 +505,7 @@ void UMockStoreDataProviderSubsystem::CreateDummyOwnedStoreData(TFunction<void()
 	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
 
 	BackendOwnedStoreItems.Empty(BackendStoreItems.Num());
+	OwnedItemsSnapshot.Reset();
 	for (const FStoreItem& StoreItem : BackendStoreItems)
 	{
 		if (StoreItem.bIsOwned)
@@ -352,6 +522,36 @@ void UMockStoreDataProviderSubsystem::CreateDummyOwnedStoreData(TFunction<void()
 	}
 }
 
+void UMockStoreDataProviderSubsystem::RecordTransaction(const FTransactionRequest& Request)
+{
+	++BackendVersion;
+	StoreItemsSnapshot.Reset();
+	OwnedItemsSnapshot.Reset();
+	for (const FName& ItemId : Request.ItemIds)
+	{
+		ChangeLog.Add({ BackendVersion, EMockChangeList::Store, ItemId });
+		ChangeLog.Add({ BackendVersion, EMockChangeList::Owned, ItemId });
+	}
+	ChangeLog.Add({ BackendVersion, EMockChangeList::Currency, NAME_None });
+
+	if (ChangeLog.Num() > MaxChangeLogEntries)
+	{
+		const int32 NumDropped = ChangeLog.Num() - MaxChangeLogEntries;
+		OldestLoggedVersion = ChangeLog[NumDropped - 1].Version;
+		ChangeLog.RemoveAt(0, NumDropped, EAllowShrinking::No);
+	}
+}
+
+TSharedRef<const FStoreCatalogSnapshot> UMockStoreDataProviderSubsystem::GetSnapshot(TSharedPtr<const FStoreCatalogSnapshot>& Snapshot, const TArray<FStoreItem>& Items) const
+{
+	if (!Snapshot.IsValid())
+	{
+		TArray<FStoreItem> Rows = Items;
+		Snapshot = FStoreCatalogSnapshot::Create(MoveTemp(Rows), BackendVersion);
+	}
+	return Snapshot.ToSharedRef();
+}
+
 void UMockStoreDataProviderSubsystem::CreateDummyPlayerCurrency()
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
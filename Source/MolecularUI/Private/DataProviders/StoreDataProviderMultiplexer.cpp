@@ -0,0 +1,339 @@
+// Copyright Mike Desrosiers, All Rights Reserved.
+
+#include "DataProviders/StoreDataProviderMultiplexer.h"
+
+#include "Utils/LogMolecularUI.h"
+
+namespace StoreDataProviderMultiplexer_private
+{
+	// Hands a result each subscriber may take ownership of. All but the last get a copy.
+	template<typename ValueType>
+	void FanOutMoved(TArray<TFunction<void(ValueType&&, const FText&)>>& Callbacks, ValueType&& Value, const FText& Status)
+	{
+		for (int32 Index = 0; Index < Callbacks.Num(); ++Index)
+		{
+			if (Index + 1 < Callbacks.Num())
+			{
+				ValueType Copy = Value;
+				Callbacks[Index](MoveTemp(Copy), Status);
+			}
+			else
+			{
+				Callbacks[Index](MoveTemp(Value), Status);
+			}
+		}
+	}
+
+	void FanOutFailure(TArray<TFunction<void(const FText&)>>& Callbacks, const FText& Error)
+	{
+		for (TFunction<void(const FText&)>& OnFailure : Callbacks)
+		{
+			OnFailure(Error);
+		}
+	}
+
+	// Answers a request made before an inner provider was set. Checked before subscribing, since a request that is
+	// never sent would keep its entry and every later caller of the same read would wait on it.
+	void FailWithoutProvider(const TFunction<void(const FText&)>& OnFailure)
+	{
+		UE_LOG(LogMolecularUI, Warning, TEXT("[%hs] No inner store data provider set."), __FUNCTION__);
+		if (OnFailure)
+		{
+			OnFailure(FText::FromString(TEXT("Store data provider unavailable.")));
+		}
+	}
+}
+
+template<typename KeyType, typename... ResultTypes>
+TSharedPtr<UStoreDataProviderMultiplexer::TSubscribers<ResultTypes...>> UStoreDataProviderMultiplexer::Subscribe(
+	TMap<KeyType, TSharedRef<TSubscribers<ResultTypes...>>>& InFlight, const KeyType& Key,
+	TFunction<void(ResultTypes...)>&& OnSuccess, TFunction<void(const FText&)>&& OnFailure)
+{
+	if (TSharedRef<TSubscribers<ResultTypes...>>* Existing = InFlight.Find(Key))
+	{
+		(*Existing)->OnSuccess.Add(MoveTemp(OnSuccess));
+		(*Existing)->OnFailure.Add(MoveTemp(OnFailure));
+		++NumCoalescedRequests;
+		return nullptr;
+	}
+
+	TSharedRef<TSubscribers<ResultTypes...>> Subscribers = MakeShared<TSubscribers<ResultTypes...>>();
+	Subscribers->OnSuccess.Add(MoveTemp(OnSuccess));
+	Subscribers->OnFailure.Add(MoveTemp(OnFailure));
+	InFlight.Add(Key, Subscribers);
+	return Subscribers;
+}
+
+void UStoreDataProviderMultiplexer::FetchStoreItems(TFunction<void(const TSharedRef<const FStoreCatalogSnapshot>&, const FText&)> OnSuccess,
+											 TFunction<void(const FText&)> OnFailure)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	using namespace StoreDataProviderMultiplexer_private;
+
+	if (!InnerProvider)
+	{
+		FailWithoutProvider(OnFailure);
+		return;
+	}
+
+	static const FName Key(TEXT("Store"));
+	TSharedPtr<FItemListSubscribers> Subscribers = Subscribe(ItemListRequests, Key, MoveTemp(OnSuccess), MoveTemp(OnFailure));
+	if (!Subscribers.IsValid())
+	{
+		return;
+	}
+
+	// Every callback leaves the map before fanning out, so a subscriber that asks again starts a fresh request.
+	InnerProvider->FetchStoreItems(
+		[WeakThis = TWeakObjectPtr<ThisClass>(this), Subscribers](const TSharedRef<const FStoreCatalogSnapshot>& Snapshot, const FText& Status)
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->ItemListRequests.Remove(Key);
+			}
+			for (TFunction<void(const TSharedRef<const FStoreCatalogSnapshot>&, const FText&)>& Callback : Subscribers->OnSuccess)
+			{
+				Callback(Snapshot, Status);
+			}
+		},
+		[WeakThis = TWeakObjectPtr<ThisClass>(this), Subscribers](const FText& Error)
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->ItemListRequests.Remove(Key);
+			}
+			FanOutFailure(Subscribers->OnFailure, Error);
+		});
+}
+
+void UStoreDataProviderMultiplexer::FetchStoreItemsPage(const FString& Cursor, const int32 PageSize,
+												 TFunction<void(FStoreItemPage&&, const FText&)> OnPage,
+												 TFunction<void(const FText&)> OnFailure)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	using namespace StoreDataProviderMultiplexer_private;
+
+	if (!InnerProvider)
+	{
+		FailWithoutProvider(OnFailure);
+		return;
+	}
+
+	const FString Key = FString::Printf(TEXT("%s/%d"), *Cursor, PageSize);
+	TSharedPtr<FPageSubscribers> Subscribers = Subscribe(PageRequests, Key, MoveTemp(OnPage), MoveTemp(OnFailure));
+	if (!Subscribers.IsValid())
+	{
+		return;
+	}
+
+	InnerProvider->FetchStoreItemsPage(Cursor, PageSize,
+		[WeakThis = TWeakObjectPtr<ThisClass>(this), Subscribers, Key](FStoreItemPage&& Page, const FText& Status)
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->PageRequests.Remove(Key);
+			}
+			FanOutMoved(Subscribers->OnSuccess, MoveTemp(Page), Status);
+		},
+		[WeakThis = TWeakObjectPtr<ThisClass>(this), Subscribers, Key](const FText& Error)
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->PageRequests.Remove(Key);
+			}
+			FanOutFailure(Subscribers->OnFailure, Error);
+		});
+}
+
+void UStoreDataProviderMultiplexer::FetchStoreChanges(const int64 SinceVersion,
+											   TFunction<void(FStoreChangeSet&&, const FText&)> OnSuccess,
+											   TFunction<void(const FText&)> OnFailure)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	using namespace StoreDataProviderMultiplexer_private;
+
+	if (!InnerProvider)
+	{
+		FailWithoutProvider(OnFailure);
+		return;
+	}
+
+	TSharedPtr<FChangeSubscribers> Subscribers = Subscribe(ChangeRequests, SinceVersion, MoveTemp(OnSuccess), MoveTemp(OnFailure));
+	if (!Subscribers.IsValid())
+	{
+		return;
+	}
+
+	InnerProvider->FetchStoreChanges(SinceVersion,
+		[WeakThis = TWeakObjectPtr<ThisClass>(this), Subscribers, SinceVersion](FStoreChangeSet&& Changes, const FText& Status)
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->ChangeRequests.Remove(SinceVersion);
+			}
+			FanOutMoved(Subscribers->OnSuccess, MoveTemp(Changes), Status);
+		},
+		[WeakThis = TWeakObjectPtr<ThisClass>(this), Subscribers, SinceVersion](const FText& Error)
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->ChangeRequests.Remove(SinceVersion);
+			}
+			FanOutFailure(Subscribers->OnFailure, Error);
+		});
+}
+
+void UStoreDataProviderMultiplexer::FetchOwnedItems(TFunction<void(const TSharedRef<const FStoreCatalogSnapshot>&, const FText&)> OnSuccess,
+											 TFunction<void(const FText&)> OnFailure)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	using namespace StoreDataProviderMultiplexer_private;
+
+	if (!InnerProvider)
+	{
+		FailWithoutProvider(OnFailure);
+		return;
+	}
+
+	static const FName Key(TEXT("Owned"));
+	TSharedPtr<FItemListSubscribers> Subscribers = Subscribe(ItemListRequests, Key, MoveTemp(OnSuccess), MoveTemp(OnFailure));
+	if (!Subscribers.IsValid())
+	{
+		return;
+	}
+
+	InnerProvider->FetchOwnedItems(
+		[WeakThis = TWeakObjectPtr<ThisClass>(this), Subscribers](const TSharedRef<const FStoreCatalogSnapshot>& Snapshot, const FText& Status)
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->ItemListRequests.Remove(Key);
+			}
+			for (TFunction<void(const TSharedRef<const FStoreCatalogSnapshot>&, const FText&)>& Callback : Subscribers->OnSuccess)
+			{
+				Callback(Snapshot, Status);
+			}
+		},
+		[WeakThis = TWeakObjectPtr<ThisClass>(this), Subscribers](const FText& Error)
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->ItemListRequests.Remove(Key);
+			}
+			FanOutFailure(Subscribers->OnFailure, Error);
+		});
+}
+
+void UStoreDataProviderMultiplexer::FetchPlayerCurrency(TFunction<void(int32, const FText&)> OnSuccess,
+												 TFunction<void(const FText&)> OnFailure)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	using namespace StoreDataProviderMultiplexer_private;
+
+	if (!InnerProvider)
+	{
+		FailWithoutProvider(OnFailure);
+		return;
+	}
+
+	TSharedPtr<FCurrencySubscribers> Subscribers = Subscribe(CurrencyRequests, FName(), MoveTemp(OnSuccess), MoveTemp(OnFailure));
+	if (!Subscribers.IsValid())
+	{
+		return;
+	}
+
+	InnerProvider->FetchPlayerCurrency(
+		[WeakThis = TWeakObjectPtr<ThisClass>(this), Subscribers](const int32 Currency, const FText& Status)
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->CurrencyRequests.Remove(FName());
+			}
+			for (TFunction<void(int32, const FText&)>& Callback : Subscribers->OnSuccess)
+			{
+				Callback(Currency, Status);
+			}
+		},
+		[WeakThis = TWeakObjectPtr<ThisClass>(this), Subscribers](const FText& Error)
+		{
+			if (WeakThis.IsValid())
+			{
+				WeakThis->CurrencyRequests.Remove(FName());
+			}
+			FanOutFailure(Subscribers->OnFailure, Error);
+		});
+}
+
+void UStoreDataProviderMultiplexer::PurchaseItem(const FTransactionRequest& Request,
+										  TFunction<void(const FText&)> OnSuccess,
+										  TFunction<void(const FText&)> OnFailure)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	if (!InnerProvider)
+	{
+		StoreDataProviderMultiplexer_private::FailWithoutProvider(OnFailure);
+		return;
+	}
+	TransactionQueue.Add({ Request, /*bPurchase*/ true, MoveTemp(OnSuccess), MoveTemp(OnFailure) });
+	SendNextTransaction();
+}
+
+void UStoreDataProviderMultiplexer::SellItem(const FTransactionRequest& Request,
+									  TFunction<void(const FText&)> OnSuccess,
+									  TFunction<void(const FText&)> OnFailure)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	if (!InnerProvider)
+	{
+		StoreDataProviderMultiplexer_private::FailWithoutProvider(OnFailure);
+		return;
+	}
+	TransactionQueue.Add({ Request, /*bPurchase*/ false, MoveTemp(OnSuccess), MoveTemp(OnFailure) });
+	SendNextTransaction();
+}
+
+int32 UStoreDataProviderMultiplexer::GetSellRefund(const FStoreItem& Item) const
+{
+	return InnerProvider ? InnerProvider->GetSellRefund(Item) : IStoreDataProvider::GetSellRefund(Item);
+}
+
+void UStoreDataProviderMultiplexer::SendNextTransaction()
+{
+	if (bTransactionInFlight || TransactionQueue.IsEmpty() || !InnerProvider)
+	{
+		return;
+	}
+	bTransactionInFlight = true;
+	FQueuedTransaction Transaction = MoveTemp(TransactionQueue[0]);
+	TransactionQueue.RemoveAt(0);
+	UE_LOG(LogMolecularUI, Verbose, TEXT("[%hs] Sending %s, %d more queued."), __FUNCTION__, *Transaction.Request.ToString(), TransactionQueue.Num());
+
+	// The next transaction goes out once this one settles, after its caller has seen the result.
+	auto OnSuccess = [WeakThis = TWeakObjectPtr<ThisClass>(this), OnSuccess = MoveTemp(Transaction.OnSuccess)](const FText& Status)
+	{
+		OnSuccess(Status);
+		if (WeakThis.IsValid())
+		{
+			WeakThis->bTransactionInFlight = false;
+			WeakThis->SendNextTransaction();
+		}
+	};
+	auto OnFailure = [WeakThis = TWeakObjectPtr<ThisClass>(this), OnFailure = MoveTemp(Transaction.OnFailure)](const FText& Error)
+	{
+		OnFailure(Error);
+		if (WeakThis.IsValid())
+		{
+			WeakThis->bTransactionInFlight = false;
+			WeakThis->SendNextTransaction();
+		}
+	};
+
+	if (Transaction.bPurchase)
+	{
+		InnerProvider->PurchaseItem(Transaction.Request, MoveTemp(OnSuccess), MoveTemp(OnFailure));
+	}
+	else
+	{
+		InnerProvider->SellItem(Transaction.Request, MoveTemp(OnSuccess), MoveTemp(OnFailure));
+	}
+}
@@ -0,0 +1,1351 @@
+// Copyright Mike Desrosiers, All Rights Reserved.
+
+#include "Models/StoreCatalogIndex.h"
+
+#include <Algo/BinarySearch.h>
+#include <Algo/IsSorted.h>
+#include <Algo/Reverse.h>
+#include <Algo/Sort.h>
+#include <Algo/StableSort.h>
+#include <Async/ParallelFor.h>
+#include <Math/VectorRegister.h>
+
+#include "Utils/MolecularRadixSort.h"
+
+// The fuzzy scan kernel uses 256-bit compares when the build targets AVX2, see FStoreFuzzyIndex.
+#if !PLATFORM_ENABLE_VECTORINTRINSICS_NEON && defined(PLATFORM_ALWAYS_HAS_AVX_2) && PLATFORM_ALWAYS_HAS_AVX_2
+	#define MOLECULARUI_FUZZY_AVX2 1
+	#include <immintrin.h>
+#else
+	#define MOLECULARUI_FUZZY_AVX2 0
+#endif
+
+namespace StoreCatalogIndex_private
+{
+	// Base letter for each lower-cased code point from U+00C0 to U+017F, or '*' to keep the code point as is.
+	// Upper-case entries are listed too, for letters the active culture's lower-casing leaves alone.
+	constexpr int32 DiacriticTableStart = 0xC0;
+	constexpr ANSICHAR DiacriticTable[] =
+		"aaaaaa*ceeeeiiii*nooooo*ouuuuy**"
+		"aaaaaa*ceeeeiiii*nooooo*ouuuuy*y"
+		"aaaaaaccccccccddddeeeeeeeeeegggg"
+		"gggghhhhiiiiiiiiii**jjkkklllllll"
+		"lllnnnnnn***oooooo**rrrrrrssssss"
+		"ssttttttuuuuuuuuuuuuwwyyyzzzzzzs";
+	constexpr int32 DiacriticTableEnd = DiacriticTableStart + UE_ARRAY_COUNT(DiacriticTable) - 1;
+
+	FORCEINLINE bool IsCombiningMark(const TCHAR Char)
+	{
+		return Char >= 0x0300 && Char <= 0x036F;
+	}
+
+	// Orders category tag names alphabetically, ignoring case. Items without a category come first.
+	int32 CompareCategoryNames(const FName A, const FName B)
+	{
+		if (A.IsNone() || B.IsNone())
+		{
+			return A.IsNone() == B.IsNone() ? 0 : (A.IsNone() ? -1 : 1);
+		}
+		return A.Compare(B);
+	}
+
+	/**
+	 * Takes the given items out of an ordering and merges them back in where Less places them now. Items the ordering
+	 * doesn't list yet are inserted. Costs O(n + k log n) for k items instead of a full sort.
+	 */
+	template <typename LessType>
+	void MergeItems(TArray<int32>& Order, TConstArrayView<int32> ItemIndices, const int32 NumItems, LessType Less)
+	{
+		TBitArray<> Moved(false, NumItems);
+		TArray<int32> Sorted;
+		Sorted.Reserve(ItemIndices.Num());
+		for (const int32 ItemIndex : ItemIndices)
+		{
+			if (!Moved[ItemIndex])
+			{
+				Moved[ItemIndex] = true;
+				Sorted.Add(ItemIndex);
+			}
+		}
+		Order.RemoveAll([&Moved](const int32 ItemIndex) { return Moved[ItemIndex]; });
+		Algo::Sort(Sorted, Less);
+
+		TArray<int32> Merged;
+		Merged.Reserve(Order.Num() + Sorted.Num());
+		int32 OrderIndex = 0;
+		for (const int32 ItemIndex : Sorted)
+		{
+			const TConstArrayView<int32> Rest(Order.GetData() + OrderIndex, Order.Num() - OrderIndex);
+			const int32 InsertIndex = OrderIndex + Algo::LowerBound(Rest, ItemIndex, Less);
+			Merged.Append(Order.GetData() + OrderIndex, InsertIndex - OrderIndex);
+			Merged.Add(ItemIndex);
+			OrderIndex = InsertIndex;
+		}
+		Merged.Append(Order.GetData() + OrderIndex, Order.Num() - OrderIndex);
+		Order = MoveTemp(Merged);
+	}
+}
+
+FString FStoreTextIndex::FoldText(const FString& Text)
+{
+	using namespace StoreCatalogIndex_private;
+
+	// FText::ToLower applies the active culture's case mapping, unlike FString::ToLower.
+	FString Folded = FText::FromString(Text).ToLower().ToString();
+
+	int32 WriteIndex = 0;
+	for (int32 ReadIndex = 0; ReadIndex < Folded.Len(); ++ReadIndex)
+	{
+		TCHAR Char = Folded[ReadIndex];
+		if (IsCombiningMark(Char))
+		{
+			continue; // Decomposed accents, dropped along with the precomposed ones below.
+		}
+		if (Char >= DiacriticTableStart && Char < DiacriticTableEnd && DiacriticTable[Char - DiacriticTableStart] != '*')
+		{
+			Char = DiacriticTable[Char - DiacriticTableStart];
+		}
+		Folded[WriteIndex++] = Char;
+	}
+	Folded.LeftInline(WriteIndex, EAllowShrinking::No);
+	return Folded;
+}
+
+void FStoreTextIndex::Build(const TArray<FStoreItem>& Items)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	Reset();
+	Append(Items);
+	KeyBuffer.Shrink();
+}
+
+void FStoreTextIndex::Append(const TArray<FStoreItem>& Items)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	KeyOffsets.Reserve(Items.Num());
+	KeyLengths.Reserve(Items.Num());
+
+	for (int32 ItemIndex = Num(); ItemIndex < Items.Num(); ++ItemIndex)
+	{
+		const FString Key = FoldText(Items[ItemIndex].UIData.DisplayName.ToString());
+		KeyOffsets.Add(KeyBuffer.Num());
+		KeyLengths.Add(Key.Len());
+		KeyBuffer.Append(*Key, Key.Len());
+		AddPostings(ItemIndex, Key);
+	}
+}
+
+bool FStoreTextIndex::Update(const int32 ItemIndex, const FStoreItem& Item)
+{
+	const FString Key = FoldText(Item.UIData.DisplayName.ToString());
+	if (GetKey(ItemIndex).Equals(Key, ESearchCase::CaseSensitive))
+	{
+		return false;
+	}
+	KeyOffsets[ItemIndex] = KeyBuffer.Num();
+	KeyLengths[ItemIndex] = Key.Len();
+	KeyBuffer.Append(*Key, Key.Len());
+	AddPostings(ItemIndex, Key);
+	return true;
+}
+
+void FStoreTextIndex::AddPostings(const int32 ItemIndex, const FStringView Key)
+{
+	for (int32 CharIndex = 0; CharIndex + 2 < Key.Len(); ++CharIndex)
+	{
+		TArray<int32>& Posting = Postings.FindOrAdd(MakeTrigram(Key[CharIndex], Key[CharIndex + 1], Key[CharIndex + 2]));
+
+		// Appended items come last, so only a re-indexed item, or a gram repeated within one name, needs a search.
+		if (Posting.IsEmpty() || Posting.Last() < ItemIndex)
+		{
+			Posting.Add(ItemIndex);
+			continue;
+		}
+		const int32 InsertIndex = Algo::LowerBound(Posting, ItemIndex);
+		if (Posting[InsertIndex] != ItemIndex)
+		{
+			Posting.Insert(ItemIndex, InsertIndex);
+		}
+	}
+}
+
+void FStoreTextIndex::Reset()
+{
+	KeyBuffer.Reset();
+	KeyOffsets.Reset();
+	KeyLengths.Reset();
+	Postings.Reset();
+}
+
+void FStoreTextIndex::FindMatches(const FString& FoldedQuery, TArray<int32>& OutItemIndices) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	GatherCandidates(FoldedQuery, OutItemIndices);
+	OutItemIndices.RemoveAll([this, &FoldedQuery](const int32 ItemIndex)
+	{
+		return !ItemMatches(ItemIndex, FoldedQuery);
+	});
+}
+
+void FStoreTextIndex::GatherCandidates(const FString& FoldedQuery, TArray<int32>& OutItemIndices) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	OutItemIndices.Reset();
+
+	if (FoldedQuery.Len() < 3)
+	{
+		// Too short to form a gram. Nearly every item matches such a query anyway, so every item is a candidate.
+		OutItemIndices.Reserve(Num());
+		for (int32 ItemIndex = 0; ItemIndex < Num(); ++ItemIndex)
+		{
+			OutItemIndices.Add(ItemIndex);
+		}
+		return;
+	}
+
+	TArray<const TArray<int32>*, TInlineAllocator<16>> QueryPostings;
+	for (int32 CharIndex = 0; CharIndex + 2 < FoldedQuery.Len(); ++CharIndex)
+	{
+		const TArray<int32>* Posting = Postings.Find(MakeTrigram(FoldedQuery[CharIndex], FoldedQuery[CharIndex + 1], FoldedQuery[CharIndex + 2]));
+		if (Posting == nullptr)
+		{
+			return; // A gram no item contains, nothing can match.
+		}
+		QueryPostings.Add(Posting);
+	}
+
+	// Intersect starting from the rarest gram to keep the working set as small as possible.
+	Algo::SortBy(QueryPostings, [](const TArray<int32>* Posting) { return Posting->Num(); });
+
+	OutItemIndices = *QueryPostings[0];
+	for (int32 PostingIndex = 1; PostingIndex < QueryPostings.Num() && !OutItemIndices.IsEmpty(); ++PostingIndex)
+	{
+		IntersectSorted(OutItemIndices, *QueryPostings[PostingIndex]);
+	}
+}
+
+void FStoreTextIndex::IntersectSorted(TArray<int32>& InOut, const TArray<int32>& Other)
+{
+	int32 WriteIndex = 0;
+	int32 OtherIndex = 0;
+	for (int32 ReadIndex = 0; ReadIndex < InOut.Num() && OtherIndex < Other.Num(); ++ReadIndex)
+	{
+		const int32 Value = InOut[ReadIndex];
+		while (OtherIndex < Other.Num() && Other[OtherIndex] < Value)
+		{
+			++OtherIndex;
+		}
+		if (OtherIndex < Other.Num() && Other[OtherIndex] == Value)
+		{
+			InOut[WriteIndex++] = Value;
+		}
+	}
+	InOut.SetNum(WriteIndex, EAllowShrinking::No);
+}
+
+namespace StoreCatalogIndex_private
+{
+	// Code units a single vector compare covers.
+	constexpr int32 VectorWidth = MOLECULARUI_FUZZY_AVX2 ? 16 : 8;
+
+	/**
+	 * Finds the first occurrence of Char in Text[From, Len), or INDEX_NONE.
+	 * Text must stay readable for VectorWidth code units past Len, since the last load may run over the end.
+	 */
+	FORCEINLINE int32 FindNext(const uint16* Text, int32 From, const int32 Len, const uint16 Char)
+	{
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+		const uint16x8_t Needle = vdupq_n_u16(Char);
+		for (; From < Len; From += VectorWidth)
+		{
+			// Narrowing each 16-bit lane to 8 bits turns the compare into a 64-bit mask with one byte per lane.
+			const uint16x8_t Equal = vceqq_u16(vld1q_u16(Text + From), Needle);
+			const uint64 Mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(Equal, 4)), 0);
+			if (Mask != 0)
+			{
+				const int32 Found = From + static_cast<int32>(FPlatformMath::CountTrailingZeros64(Mask) >> 3);
+				return Found < Len ? Found : INDEX_NONE;
+			}
+		}
+		return INDEX_NONE;
+#elif MOLECULARUI_FUZZY_AVX2
+		const __m256i Needle = _mm256_set1_epi16(static_cast<int16>(Char));
+		for (; From < Len; From += VectorWidth)
+		{
+			// Two mask bits per 16-bit lane, as with SSE2.
+			const __m256i Equal = _mm256_cmpeq_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(Text + From)), Needle);
+			const uint32 Mask = static_cast<uint32>(_mm256_movemask_epi8(Equal));
+			if (Mask != 0)
+			{
+				const int32 Found = From + static_cast<int32>(FPlatformMath::CountTrailingZeros(Mask) >> 1);
+				return Found < Len ? Found : INDEX_NONE;
+			}
+		}
+		return INDEX_NONE;
+#elif PLATFORM_ENABLE_VECTORINTRINSICS
+		const __m128i Needle = _mm_set1_epi16(static_cast<int16>(Char));
+		for (; From < Len; From += VectorWidth)
+		{
+			// Two mask bits per 16-bit lane.
+			const __m128i Equal = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Text + From)), Needle);
+			const uint32 Mask = static_cast<uint32>(_mm_movemask_epi8(Equal));
+			if (Mask != 0)
+			{
+				const int32 Found = From + static_cast<int32>(FPlatformMath::CountTrailingZeros(Mask) >> 1);
+				return Found < Len ? Found : INDEX_NONE;
+			}
+		}
+		return INDEX_NONE;
+#else
+		for (; From < Len; ++From)
+		{
+			if (Text[From] == Char)
+			{
+				return From;
+			}
+		}
+		return INDEX_NONE;
+#endif
+	}
+
+	FORCEINLINE bool IsWordSeparator(const uint16 Char)
+	{
+		return Char == ' ' || Char == '_' || Char == '-' || Char == '.' || Char == '\'';
+	}
+
+	// Score weights. A clean prefix match of a short name outranks a scattered match of a long one.
+	constexpr int32 MatchScore = 16;
+	constexpr int32 ConsecutiveBonus = 24;
+	constexpr int32 WordStartBonus = 20;
+	constexpr int32 MaxGapPenalty = 12;
+	constexpr int32 TypoPenalty = 48;
+
+	struct FScoredItem
+	{
+		int32 Score;
+		int32 ItemIndex;
+	};
+
+	// Orders the heap so its top is the weakest kept match. Ties go to the earlier item.
+	struct FWorseScore
+	{
+		bool operator()(const FScoredItem& A, const FScoredItem& B) const
+		{
+			return A.Score != B.Score ? A.Score < B.Score : A.ItemIndex > B.ItemIndex;
+		}
+	};
+
+	// Keeps the best MaxResults scored items in a heap, or every one when MaxResults is zero or less.
+	class FBestScores
+	{
+	public:
+		FBestScores(const int32 InMaxResults, const int32 MaxCandidates)
+			: MaxResults(InMaxResults)
+		{
+			Kept.Reserve(MaxResults > 0 ? FMath::Min(MaxResults + 1, MaxCandidates) : MaxCandidates);
+		}
+
+		void Add(const int32 Score, const int32 ItemIndex)
+		{
+			const FScoredItem Scored{ Score, ItemIndex };
+			if (MaxResults <= 0)
+			{
+				Kept.Add(Scored);
+			}
+			else if (Kept.Num() < MaxResults)
+			{
+				Kept.HeapPush(Scored, FWorseScore());
+			}
+			else if (FWorseScore()(Kept.HeapTop(), Scored))
+			{
+				Kept.HeapPopDiscard(FWorseScore(), EAllowShrinking::No);
+				Kept.HeapPush(Scored, FWorseScore());
+			}
+		}
+
+		// Best first.
+		void Finish(TArray<int32>& OutItemIndices)
+		{
+			Algo::Sort(Kept, [](const FScoredItem& A, const FScoredItem& B) { return FWorseScore()(B, A); });
+			OutItemIndices.Reset(Kept.Num());
+			for (const FScoredItem& Scored : Kept)
+			{
+				OutItemIndices.Add(Scored.ItemIndex);
+			}
+		}
+
+	private:
+		int32 MaxResults;
+		TArray<FScoredItem> Kept;
+	};
+}
+
+void FStoreFuzzyIndex::Build(const FStoreTextIndex& TextIndex)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	Reset();
+	Append(TextIndex);
+}
+
+void FStoreFuzzyIndex::Append(const FStoreTextIndex& TextIndex)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	if (!PackedNames.IsEmpty())
+	{
+		PackedNames.SetNum(PackedNames.Num() - StoreCatalogIndex_private::VectorWidth, EAllowShrinking::No); // The padding, re-added after the new names.
+	}
+	NameOffsets.Reserve(TextIndex.Num());
+	NameLengths.Reserve(TextIndex.Num());
+	CharMasks.Reserve(TextIndex.Num());
+
+	for (int32 ItemIndex = Num(); ItemIndex < TextIndex.Num(); ++ItemIndex)
+	{
+		const FStringView Key = TextIndex.GetKey(ItemIndex);
+		NameOffsets.Add(PackedNames.Num());
+		NameLengths.Add(Key.Len());
+		CharMasks.Add(PackName(Key));
+	}
+
+	PackedNames.AddZeroed(StoreCatalogIndex_private::VectorWidth);
+}
+
+void FStoreFuzzyIndex::Update(const int32 ItemIndex, const FStoreTextIndex& TextIndex)
+{
+	PackedNames.SetNum(PackedNames.Num() - StoreCatalogIndex_private::VectorWidth, EAllowShrinking::No); // The padding, re-added after the name.
+	const FStringView Key = TextIndex.GetKey(ItemIndex);
+	NameOffsets[ItemIndex] = PackedNames.Num();
+	NameLengths[ItemIndex] = Key.Len();
+	CharMasks[ItemIndex] = PackName(Key);
+	PackedNames.AddZeroed(StoreCatalogIndex_private::VectorWidth);
+}
+
+uint64 FStoreFuzzyIndex::PackName(const FStringView Key)
+{
+	uint64 CharMask = 0;
+	for (const TCHAR Char : Key)
+	{
+		const uint16 CodeUnit = static_cast<uint16>(Char);
+		PackedNames.Add(CodeUnit);
+		CharMask |= CharBit(CodeUnit);
+	}
+	return CharMask;
+}
+
+void FStoreFuzzyIndex::Reset()
+{
+	PackedNames.Reset();
+	NameOffsets.Reset();
+	NameLengths.Reset();
+	CharMasks.Reset();
+}
+
+FStoreFuzzyIndex::FQuery FStoreFuzzyIndex::PrepareQuery(const FString& FoldedQuery)
+{
+	FQuery Query;
+	for (const TCHAR Char : FoldedQuery)
+	{
+		Query.Chars.Add(static_cast<uint16>(Char));
+		Query.CharMask |= CharBit(static_cast<uint16>(Char));
+	}
+	Query.MaxTypos = GetMaxTypos(Query.Chars.Num());
+	return Query;
+}
+
+const TCHAR* FStoreFuzzyIndex::GetKernelName()
+{
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+	return TEXT("NEON");
+#elif MOLECULARUI_FUZZY_AVX2
+	return TEXT("AVX2");
+#elif PLATFORM_ENABLE_VECTORINTRINSICS
+	return TEXT("SSE2");
+#else
+	return TEXT("Scalar");
+#endif
+}
+
+bool FStoreFuzzyIndex::Score(const int32 ItemIndex, const FQuery& Query, int32& OutScore) const
+{
+	using namespace StoreCatalogIndex_private;
+
+	const int32 QueryLen = Query.Chars.Num();
+	const int32 NameLen = NameLengths[ItemIndex];
+
+	// Each query character the name lacks entirely is a guaranteed typo.
+	if (NameLen < QueryLen - Query.MaxTypos
+		|| FPlatformMath::CountBits(Query.CharMask & ~CharMasks[ItemIndex]) > Query.MaxTypos)
+	{
+		return false;
+	}
+
+	const uint16* Name = PackedNames.GetData() + NameOffsets[ItemIndex];
+	int32 Score = 0;
+	int32 Typos = 0;
+	int32 LastMatch = INDEX_NONE;
+	for (int32 QueryIndex = 0; QueryIndex < QueryLen; ++QueryIndex)
+	{
+		// Greedy: place each query character at its earliest occurrence after the previous one.
+		const int32 Found = FindNext(Name, LastMatch + 1, NameLen, Query.Chars[QueryIndex]);
+		if (Found == INDEX_NONE)
+		{
+			if (++Typos > Query.MaxTypos)
+			{
+				return false;
+			}
+			Score -= TypoPenalty;
+			continue;
+		}
+
+		Score += MatchScore;
+		if (LastMatch != INDEX_NONE)
+		{
+			Score += Found == LastMatch + 1 ? ConsecutiveBonus : -FMath::Min(Found - LastMatch - 1, MaxGapPenalty);
+		}
+		if (Found == 0 || IsWordSeparator(Name[Found - 1]))
+		{
+			Score += WordStartBonus;
+		}
+		LastMatch = Found;
+	}
+
+	// Prefer names with fewer characters left unmatched.
+	OutScore = Score - (NameLen - (QueryLen - Typos)) / 4;
+	return true;
+}
+
+void FStoreFuzzyIndex::Rank(const FString& FoldedQuery, const TArray<int32>& Candidates, const int32 MaxResults, TArray<int32>& OutItemIndices) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	using namespace StoreCatalogIndex_private;
+
+	const FQuery Query = PrepareQuery(FoldedQuery);
+	FBestScores Kept(MaxResults, Candidates.Num());
+	for (const int32 ItemIndex : Candidates)
+	{
+		int32 ItemScore = 0;
+		if (Score(ItemIndex, Query, ItemScore))
+		{
+			Kept.Add(ItemScore, ItemIndex);
+		}
+	}
+	Kept.Finish(OutItemIndices);
+}
+
+void FStoreCategoryIndex::Build(const TArray<FStoreItem>& Items)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	Reset();
+	Append(Items);
+}
+
+void FStoreCategoryIndex::Append(const TArray<FStoreItem>& Items)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	ItemTagOffsets.Reserve(Items.Num());
+	ItemTagCounts.Reserve(Items.Num());
+
+	// Catalogs use a handful of distinct tags, so resolve each tag's parents once instead of once per item.
+	FRollupCache RollupsByTag;
+	FRollupIds RollupIds;
+	for (int32 ItemIndex = Num(); ItemIndex < Items.Num(); ++ItemIndex)
+	{
+		CollectRollupIds(Items[ItemIndex], RollupsByTag, RollupIds);
+		for (const int32 TagId : RollupIds)
+		{
+			ItemsByTag.FindOrAdd(TagsById[TagId]).Add(ItemIndex);
+		}
+		ItemTagOffsets.Add(ItemTagIds.Num());
+		ItemTagCounts.Add(RollupIds.Num());
+		ItemTagIds.Append(RollupIds);
+	}
+}
+
+void FStoreCategoryIndex::Update(const int32 ItemIndex, const FStoreItem& Item)
+{
+	FRollupCache RollupsByTag;
+	FRollupIds RollupIds;
+	CollectRollupIds(Item, RollupsByTag, RollupIds);
+
+	const TConstArrayView<int32> OldRollupIds = GetItemTagIds(ItemIndex);
+	if (OldRollupIds.Num() == RollupIds.Num() && FMemory::Memcmp(OldRollupIds.GetData(), RollupIds.GetData(), RollupIds.Num() * sizeof(int32)) == 0)
+	{
+		return;
+	}
+	for (const int32 TagId : OldRollupIds)
+	{
+		ItemsByTag.FindChecked(TagsById[TagId]).Remove(ItemIndex);
+	}
+	for (const int32 TagId : RollupIds)
+	{
+		ItemsByTag.FindOrAdd(TagsById[TagId]).Add(ItemIndex);
+	}
+	ItemTagOffsets[ItemIndex] = ItemTagIds.Num();
+	ItemTagCounts[ItemIndex] = RollupIds.Num();
+	ItemTagIds.Append(RollupIds);
+}
+
+void FStoreCategoryIndex::CollectRollupIds(const FStoreItem& Item, FRollupCache& RollupsByTag, FRollupIds& OutRollupIds)
+{
+	OutRollupIds.Reset();
+	for (const FGameplayTag& CategoryTag : Item.Categories)
+	{
+		const FGameplayTagContainer* Rollup = RollupsByTag.Find(CategoryTag);
+		if (Rollup == nullptr)
+		{
+			Rollup = &RollupsByTag.Add(CategoryTag, CategoryTag.GetGameplayTagParents());
+		}
+		for (const FGameplayTag& RollupTag : *Rollup)
+		{
+			const int32* TagId = TagIds.Find(RollupTag);
+			if (TagId == nullptr)
+			{
+				TagId = &TagIds.Add(RollupTag, TagsById.Num());
+				TagsById.Add(RollupTag);
+			}
+
+			// Sibling tags share parents, which must only count once per item.
+			OutRollupIds.AddUnique(*TagId);
+		}
+	}
+}
+
+void FStoreCategoryIndex::Reset()
+{
+	ItemsByTag.Reset();
+	TagIds.Reset();
+	TagsById.Reset();
+	ItemTagIds.Reset();
+	ItemTagOffsets.Reset();
+	ItemTagCounts.Reset();
+}
+
+void FStoreCategoryIndex::Union(const FGameplayTagContainer& CategoryTags, FMolecularBitmap& OutItems) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	for (const FGameplayTag& CategoryTag : CategoryTags)
+	{
+		if (const FMolecularBitmap* TagItems = Find(CategoryTag))
+		{
+			OutItems |= *TagItems;
+		}
+	}
+}
+
+void FStoreCatalogColumns::Build(const TArray<FStoreItem>& Items, const FStoreCategoryIndex& CategoryIndex)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	Reset();
+	Append(Items, CategoryIndex);
+}
+
+void FStoreCatalogColumns::Append(const TArray<FStoreItem>& Items, const FStoreCategoryIndex& CategoryIndex)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	Handles.Reserve(Items.Num());
+	Costs.Reserve(Items.Num());
+	PrimaryCategories.Reserve(Items.Num());
+	CategoryMasks.Reserve(Items.Num());
+
+	// Tag ids only grow, so the masks already filled stay correct. Only their exactness can be lost.
+	bExactCategoryMasks = CategoryIndex.NumTags() <= 64;
+
+	for (int32 ItemIndex = Num(); ItemIndex < Items.Num(); ++ItemIndex)
+	{
+		const FStoreItem& Item = Items[ItemIndex];
+		Handles.Add(Item.Handle);
+		Costs.Add(Item.Cost);
+		PrimaryCategories.Add(Item.Categories.IsEmpty() ? NAME_None : Item.Categories.First().GetTagName());
+		Owned.Add(Item.bIsOwned);
+		Removed.Add(false);
+		CategoryMasks.Add(MakeItemCategoryMask(ItemIndex, CategoryIndex));
+	}
+}
+
+void FStoreCatalogColumns::Update(const int32 ItemIndex, const FStoreItem& Item, const FStoreCategoryIndex& CategoryIndex)
+{
+	bExactCategoryMasks = CategoryIndex.NumTags() <= 64;
+	Handles[ItemIndex] = Item.Handle;
+	Costs[ItemIndex] = Item.Cost;
+	PrimaryCategories[ItemIndex] = Item.Categories.IsEmpty() ? NAME_None : Item.Categories.First().GetTagName();
+	Owned[ItemIndex] = Item.bIsOwned;
+	Removed[ItemIndex] = false;
+	CategoryMasks[ItemIndex] = MakeItemCategoryMask(ItemIndex, CategoryIndex);
+}
+
+uint64 FStoreCatalogColumns::MakeItemCategoryMask(const int32 ItemIndex, const FStoreCategoryIndex& CategoryIndex)
+{
+	uint64 CategoryMask = 0;
+	for (const int32 TagId : CategoryIndex.GetItemTagIds(ItemIndex))
+	{
+		CategoryMask |= TagId < 64 ? 1ull << TagId : 0;
+	}
+	return CategoryMask;
+}
+
+void FStoreCatalogColumns::Reset()
+{
+	Handles.Reset();
+	Costs.Reset();
+	PrimaryCategories.Reset();
+	Owned.Reset();
+	Removed.Reset();
+	CategoryMasks.Reset();
+	bExactCategoryMasks = true;
+}
+
+uint64 FStoreCatalogColumns::MakeCategoryMask(const FGameplayTagContainer& CategoryTags, const FStoreCategoryIndex& CategoryIndex)
+{
+	uint64 QueryMask = 0;
+	for (const FGameplayTag& CategoryTag : CategoryTags)
+	{
+		const int32 TagId = CategoryIndex.FindTagId(CategoryTag);
+		if (TagId != INDEX_NONE && TagId < 64)
+		{
+			QueryMask |= 1ull << TagId;
+		}
+	}
+	return QueryMask;
+}
+
+void FStoreCostIndex::Build(TConstArrayView<int32> CostsByItem)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	Reset();
+	ItemsByCost.Reserve(CostsByItem.Num());
+	for (int32 ItemIndex = 0; ItemIndex < CostsByItem.Num(); ++ItemIndex)
+	{
+		ItemsByCost.Add(ItemIndex);
+	}
+
+	// Cost is already an integer key, so a radix sort orders it in linear time.
+	MolecularUI::RadixSort::SortBy(ItemsByCost, [&CostsByItem](const int32 ItemIndex)
+	{
+		return MolecularUI::RadixSort::SignedKey(CostsByItem[ItemIndex]);
+	});
+
+	SortedCosts.Reserve(ItemsByCost.Num());
+	for (const int32 ItemIndex : ItemsByCost)
+	{
+		SortedCosts.Add(CostsByItem[ItemIndex]);
+	}
+}
+
+void FStoreCostIndex::Update(TConstArrayView<int32> ItemIndices, TConstArrayView<int32> CostsByItem)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	// Ties keep catalog order, as the radix sort in Build leaves them.
+	StoreCatalogIndex_private::MergeItems(ItemsByCost, ItemIndices, CostsByItem.Num(), [&CostsByItem](const int32 A, const int32 B)
+	{
+		return CostsByItem[A] != CostsByItem[B] ? CostsByItem[A] < CostsByItem[B] : A < B;
+	});
+
+	SortedCosts.Reset(ItemsByCost.Num());
+	for (const int32 ItemIndex : ItemsByCost)
+	{
+		SortedCosts.Add(CostsByItem[ItemIndex]);
+	}
+}
+
+void FStoreCostIndex::Reset()
+{
+	ItemsByCost.Reset();
+	SortedCosts.Reset();
+}
+
+TConstArrayView<int32> FStoreCostIndex::FindRange(const int32 MinCost, const int32 MaxCost) const
+{
+	if (MinCost > MaxCost)
+	{
+		return TConstArrayView<int32>();
+	}
+	const int32 First = Algo::LowerBound(SortedCosts, MinCost);
+	const int32 Last = Algo::UpperBound(SortedCosts, MaxCost);
+	return TConstArrayView<int32>(ItemsByCost.GetData() + First, Last - First);
+}
+
+void FStoreSortIndex::Build(const FStoreCatalogColumns& Columns, const FStoreTextIndex& TextIndex, const FStoreCostIndex& CostIndex)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	Reset();
+
+	// The cost index has already radix sorted the items by cost.
+	BuildRanks(CostIndex.GetItemsByCost(), CostRanks);
+
+	// Names compare by their folded keys, ordinally, so no FText comparison runs per pair.
+	NameOrder = CostIndex.GetItemsByCost();
+	Algo::StableSort(NameOrder, [&TextIndex](const int32 A, const int32 B)
+	{
+		return TextIndex.GetKey(A).Compare(TextIndex.GetKey(B), ESearchCase::CaseSensitive) < 0;
+	});
+	BuildRanks(NameOrder, NameRanks);
+
+	// Catalogs use a handful of distinct tags, so only those are compared by name. Each item then sorts by its tag's
+	// position, and the radix sort is stable, so the name order breaks ties by name.
+	TArray<FName> CategoryNames = TSet<FName>(Columns.PrimaryCategories).Array();
+	Algo::Sort(CategoryNames, [](const FName A, const FName B) { return StoreCatalogIndex_private::CompareCategoryNames(A, B) < 0; });
+	TMap<FName, uint32> CategoryPositions;
+	CategoryPositions.Reserve(CategoryNames.Num());
+	for (int32 Position = 0; Position < CategoryNames.Num(); ++Position)
+	{
+		CategoryPositions.Add(CategoryNames[Position], static_cast<uint32>(Position));
+	}
+	CategoryOrder = NameOrder;
+	MolecularUI::RadixSort::SortBy(CategoryOrder, [&Columns, &CategoryPositions](const int32 ItemIndex)
+	{
+		return CategoryPositions.FindChecked(Columns.PrimaryCategories[ItemIndex]);
+	});
+	BuildRanks(CategoryOrder, CategoryRanks);
+}
+
+void FStoreSortIndex::Update(TConstArrayView<int32> ItemIndices, const FStoreCatalogColumns& Columns, const FStoreTextIndex& TextIndex, const FStoreCostIndex& CostIndex)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	using namespace StoreCatalogIndex_private;
+
+	// CompareUnranked breaks ties the way Build's chain of stable sorts does, so the merged orderings match a rebuild.
+	MergeItems(NameOrder, ItemIndices, Columns.Num(), [&Columns, &TextIndex](const int32 A, const int32 B)
+	{
+		return CompareUnranked(EStoreSortField::Name, Columns, TextIndex, A, B) < 0;
+	});
+	MergeItems(CategoryOrder, ItemIndices, Columns.Num(), [&Columns, &TextIndex](const int32 A, const int32 B)
+	{
+		return CompareUnranked(EStoreSortField::Category, Columns, TextIndex, A, B) < 0;
+	});
+
+	BuildRanks(CostIndex.GetItemsByCost(), CostRanks);
+	BuildRanks(NameOrder, NameRanks);
+	BuildRanks(CategoryOrder, CategoryRanks);
+}
+
+void FStoreSortIndex::Reset()
+{
+	CostRanks.Reset();
+	NameRanks.Reset();
+	CategoryRanks.Reset();
+	NameOrder.Reset();
+	CategoryOrder.Reset();
+}
+
+void FStoreSortIndex::Sort(const FStoreSortMode& SortMode, TArray<int32>& InOutItemIndices) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	const TArray<uint32>* Ranks = nullptr;
+	switch (SortMode.Field)
+	{
+	case EStoreSortField::None:
+		// Catalog order. Refined matches arrive in the previous pass's order, so they are put back rather than left as is.
+		if (!Algo::IsSorted(InOutItemIndices))
+		{
+			MolecularUI::RadixSort::SortBy(InOutItemIndices, [](const int32 ItemIndex) { return static_cast<uint32>(ItemIndex); });
+		}
+		return;
+	case EStoreSortField::Cost:
+		Ranks = &CostRanks;
+		break;
+	case EStoreSortField::Name:
+		Ranks = &NameRanks;
+		break;
+	case EStoreSortField::Category:
+		Ranks = &CategoryRanks;
+		break;
+	}
+	if (Ranks == nullptr)
+	{
+		return;
+	}
+
+	// Ranks are unique, so inverting them reverses the order exactly.
+	const uint32 Flip = SortMode.bDescending ? MAX_uint32 : 0;
+	MolecularUI::RadixSort::SortBy(InOutItemIndices, [Ranks, Flip](const int32 ItemIndex)
+	{
+		return (*Ranks)[ItemIndex] ^ Flip;
+	});
+}
+
+void FStoreSortIndex::SortUnranked(const FStoreSortMode& SortMode, const FStoreCatalogColumns& Columns, const FStoreTextIndex& TextIndex, TArray<int32>& InOutItemIndices)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	const EStoreSortField Field = SortMode.Field;
+	if (Field == EStoreSortField::None)
+	{
+		MolecularUI::RadixSort::SortBy(InOutItemIndices, [](const int32 ItemIndex) { return static_cast<uint32>(ItemIndex); });
+		return;
+	}
+
+	Algo::Sort(InOutItemIndices, [&Columns, &TextIndex, Field](const int32 A, const int32 B)
+	{
+		return CompareUnranked(Field, Columns, TextIndex, A, B) < 0;
+	});
+
+	// The order is total, so reversing it matches the inverted ranks exactly.
+	if (SortMode.bDescending)
+	{
+		Algo::Reverse(InOutItemIndices);
+	}
+}
+
+int32 FStoreSortIndex::CompareUnranked(const EStoreSortField Field, const FStoreCatalogColumns& Columns, const FStoreTextIndex& TextIndex, const int32 A, const int32 B)
+{
+	// The ranks break ties by the fields sorted before them: category by name, name by cost, and cost by catalog order.
+	int32 Result = 0;
+	if (Field == EStoreSortField::Category)
+	{
+		Result = StoreCatalogIndex_private::CompareCategoryNames(Columns.PrimaryCategories[A], Columns.PrimaryCategories[B]);
+	}
+	if (Result == 0 && Field != EStoreSortField::Cost)
+	{
+		Result = TextIndex.GetKey(A).Compare(TextIndex.GetKey(B), ESearchCase::CaseSensitive);
+	}
+	if (Result == 0 && Columns.Costs[A] != Columns.Costs[B])
+	{
+		Result = Columns.Costs[A] < Columns.Costs[B] ? -1 : 1;
+	}
+	return Result != 0 ? Result : (A < B ? -1 : (A > B ? 1 : 0));
+}
+
+void FStoreSortIndex::BuildRanks(const TArray<int32>& Order, TArray<uint32>& OutRanks)
+{
+	OutRanks.SetNumUninitialized(Order.Num());
+	for (int32 Position = 0; Position < Order.Num(); ++Position)
+	{
+		OutRanks[Order[Position]] = static_cast<uint32>(Position);
+	}
+}
+
+void FStoreCatalogIndex::Build(const TArray<FStoreItem>& Items)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	// The category index assigns the tag ids the columns' masks are made of.
+	CategoryIndex.Build(Items);
+	Columns.Build(Items, CategoryIndex);
+	TextIndex.Build(Items);
+	FuzzyIndex.Build(TextIndex);
+	ItemIndexByHandle.Reset();
+	MapHandles(0);
+	BuildOrderings();
+	NumRemovedItems = 0;
+}
+
+void FStoreCatalogIndex::Append(const TArray<FStoreItem>& Items)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	const int32 FirstNewItem = Num();
+	CategoryIndex.Append(Items);
+	Columns.Append(Items, CategoryIndex);
+	TextIndex.Append(Items);
+	FuzzyIndex.Append(TextIndex);
+	MapHandles(FirstNewItem);
+
+	// Keeping the orderings and the histogram current would go over the whole catalog for every page.
+	if (Num() != FirstNewItem)
+	{
+		CostIndex.Reset();
+		SortIndex.Reset();
+		CostHistogram = FStoreCostHistogram();
+		bHasOrderings = false;
+	}
+}
+
+void FStoreCatalogIndex::BuildOrderings()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	CostIndex.Build(Columns.Costs);
+	SortIndex.Build(Columns, TextIndex, CostIndex);
+	BuildCostHistogram();
+	bHasOrderings = true;
+}
+
+void FStoreCatalogIndex::ApplyChanges(const TArray<FStoreItem>& Items, TConstArrayView<int32> ChangedItems, TConstArrayView<int32> RemovedItems)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	// Removed items stay where they are, so every position the model and other passes hold stays valid.
+	for (const int32 ItemIndex : RemovedItems)
+	{
+		if (!Columns.IsRemoved(ItemIndex))
+		{
+			Columns.Removed[ItemIndex] = true;
+			++NumRemovedItems;
+		}
+	}
+
+	// The category index first, since the columns' masks are made of its tag ids.
+	for (const int32 ItemIndex : ChangedItems)
+	{
+		NumRemovedItems -= Columns.IsRemoved(ItemIndex) ? 1 : 0;
+		CategoryIndex.Update(ItemIndex, Items[ItemIndex]);
+		Columns.Update(ItemIndex, Items[ItemIndex], CategoryIndex);
+		if (TextIndex.Update(ItemIndex, Items[ItemIndex]))
+		{
+			FuzzyIndex.Update(ItemIndex, TextIndex);
+		}
+	}
+
+	const int32 FirstNewItem = Num();
+	CategoryIndex.Append(Items);
+	Columns.Append(Items, CategoryIndex);
+	TextIndex.Append(Items);
+	FuzzyIndex.Append(TextIndex);
+	MapHandles(FirstNewItem);
+
+	if (!bHasOrderings)
+	{
+		return; // Built over the whole catalog once its last page is in.
+	}
+
+	// Only the changed and new items move. Removed ones keep their place, and no query matches them.
+	TArray<int32> MovedItems;
+	MovedItems.Reserve(ChangedItems.Num() + Num() - FirstNewItem);
+	MovedItems.Append(ChangedItems.GetData(), ChangedItems.Num());
+	for (int32 ItemIndex = FirstNewItem; ItemIndex < Num(); ++ItemIndex)
+	{
+		MovedItems.Add(ItemIndex);
+	}
+	if (!MovedItems.IsEmpty())
+	{
+		CostIndex.Update(MovedItems, Columns.Costs);
+		SortIndex.Update(MovedItems, Columns, TextIndex, CostIndex);
+	}
+	BuildCostHistogram();
+}
+
+void FStoreCatalogIndex::MapHandles(const int32 FirstNewItem)
+{
+	int32 MaxHandleIndex = ItemIndexByHandle.Num() - 1;
+	for (int32 ItemIndex = FirstNewItem; ItemIndex < Columns.Num(); ++ItemIndex)
+	{
+		MaxHandleIndex = FMath::Max(MaxHandleIndex, Columns.Handles[ItemIndex].Index);
+	}
+	for (int32 HandleIndex = ItemIndexByHandle.Num(); HandleIndex <= MaxHandleIndex; ++HandleIndex)
+	{
+		ItemIndexByHandle.Add(INDEX_NONE);
+	}
+	for (int32 ItemIndex = FirstNewItem; ItemIndex < Columns.Num(); ++ItemIndex)
+	{
+		if (Columns.Handles[ItemIndex].IsValid())
+		{
+			ItemIndexByHandle[Columns.Handles[ItemIndex].Index] = ItemIndex;
+		}
+	}
+}
+
+void FStoreCatalogIndex::BuildCostHistogram()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	CostHistogram = FStoreCostHistogram();
+
+	int32 MinCost = MAX_int32;
+	int32 MaxCost = MIN_int32;
+	for (int32 ItemIndex = 0; ItemIndex < Num(); ++ItemIndex)
+	{
+		if (Columns.IsAvailable(ItemIndex))
+		{
+			MinCost = FMath::Min(MinCost, Columns.Costs[ItemIndex]);
+			MaxCost = FMath::Max(MaxCost, Columns.Costs[ItemIndex]);
+		}
+	}
+	if (MinCost > MaxCost)
+	{
+		return; // Nothing available.
+	}
+
+	CostHistogram.MinCost = MinCost;
+	CostHistogram.MaxCost = MaxCost;
+	const int64 Span = static_cast<int64>(MaxCost) - MinCost + 1;
+	CostHistogram.BucketWidth = static_cast<int32>(FMath::Max<int64>((Span + NumCostHistogramBuckets - 1) / NumCostHistogramBuckets, 1));
+	CostHistogram.Counts.SetNumZeroed(NumCostHistogramBuckets);
+	for (int32 ItemIndex = 0; ItemIndex < Num(); ++ItemIndex)
+	{
+		if (Columns.IsAvailable(ItemIndex))
+		{
+			const int64 Offset = static_cast<int64>(Columns.Costs[ItemIndex]) - MinCost;
+			++CostHistogram.Counts[static_cast<int32>(Offset / CostHistogram.BucketWidth)];
+		}
+	}
+}
+
+void FStoreCatalogIndex::SortMatches(const FStoreSortMode& SortMode, TArray<int32>& InOutMatches) const
+{
+	if (bHasOrderings)
+	{
+		SortIndex.Sort(SortMode, InOutMatches);
+	}
+	else
+	{
+		FStoreSortIndex::SortUnranked(SortMode, Columns, TextIndex, InOutMatches);
+	}
+}
+
+void FStoreCatalogIndex::Match(const FStoreFilterQuery& Query, const TArray<int32>* PreviousMatches, TArray<int32>& OutMatches, const bool bParallel, FStoreFacetCounts* OutFacets) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	OutMatches.Reset();
+
+	const bool bFuzzy = Query.SearchMode == EStoreSearchMode::Fuzzy && !Query.FoldedText.IsEmpty();
+	if (OutFacets != nullptr && !bFuzzy)
+	{
+		CountFacets(Query, *OutFacets);
+	}
+
+	// Category filter, as the union of the selected tabs' item bitmaps.
+	FMolecularBitmap CategoryMatches;
+	if (!Query.bAnyCategory)
+	{
+		CategoryIndex.Union(Query.CategoryTags, CategoryMatches);
+	}
+
+	// Per-candidate category checks read the mask column when it is exact, instead of probing the bitmap.
+	const bool bUseCategoryMask = Columns.HasExactCategoryMasks();
+	const uint64 CategoryMask = bUseCategoryMask && !Query.bAnyCategory ? Columns.MakeCategoryMask(Query.CategoryTags, CategoryIndex) : 0;
+
+	if (bFuzzy)
+	{
+		MatchFuzzy(Query, CategoryMatches, CategoryMask, OutMatches, OutFacets);
+		return;
+	}
+
+	// Pick the cheapest candidate source, then note which filters the candidates still have to be checked against.
+	TArray<int32> Candidates;
+	bool bCheckText = !Query.FoldedText.IsEmpty();
+	bool bCheckCategory = !Query.bAnyCategory;
+	bool bCheckCost = Query.HasCostRange();
+
+	// The cost slice comes out in cost order, so put it back in catalog order to keep unsorted results stable.
+	// While pages are still arriving there is no cost ordering, and the cost column is checked per candidate instead.
+	const bool bHasCostSlice = bCheckCost && bHasOrderings;
+	const TConstArrayView<int32> CostSlice = bHasCostSlice ? CostIndex.FindRange(Query.MinCost, Query.MaxCost) : TConstArrayView<int32>();
+	auto UseCostSlice = [&Candidates, &CostSlice, &bCheckCost]()
+	{
+		Candidates.Reset();
+		Candidates.Append(CostSlice.GetData(), CostSlice.Num());
+		MolecularUI::RadixSort::SortBy(Candidates, [](const int32 ItemIndex) { return static_cast<uint32>(ItemIndex); });
+		bCheckCost = false;
+	};
+
+	if (PreviousMatches != nullptr)
+	{
+		Candidates = *PreviousMatches;
+	}
+	else if (bCheckText)
+	{
+		TextIndex.GatherCandidates(Query.FoldedText, Candidates);
+		if (bHasCostSlice && CostSlice.Num() < Candidates.Num())
+		{
+			UseCostSlice();
+		}
+	}
+	else if (bHasCostSlice && (!bCheckCategory || CostSlice.Num() < CategoryMatches.Num()))
+	{
+		UseCostSlice();
+	}
+	else if (bCheckCategory)
+	{
+		CategoryMatches.ToArray(Candidates);
+		bCheckCategory = false;
+	}
+	else
+	{
+		Candidates.Reserve(Num());
+		for (int32 ItemIndex = 0; ItemIndex < Num(); ++ItemIndex)
+		{
+			Candidates.Add(ItemIndex);
+		}
+	}
+
+	// Cheapest checks first. Only the text check leaves the hot columns.
+	auto IsMatch = [this, &Query, &CategoryMatches, bCheckText, bCheckCategory, bCheckCost, bUseCategoryMask, CategoryMask](const int32 ItemIndex)
+	{
+		return Columns.IsAvailable(ItemIndex)
+			&& (!bCheckCost || Columns.IsCostInRange(ItemIndex, Query.MinCost, Query.MaxCost))
+			&& (!bCheckCategory || (bUseCategoryMask ? Columns.MatchesCategoryMask(ItemIndex, CategoryMask) : CategoryMatches.Contains(ItemIndex)))
+			&& (!bCheckText || TextIndex.ItemMatches(ItemIndex, Query.FoldedText));
+	};
+
+	if (!bParallel || Candidates.Num() <= MatchChunkSize)
+	{
+		OutMatches.Reserve(Candidates.Num());
+		for (const int32 ItemIndex : Candidates)
+		{
+			if (IsMatch(ItemIndex))
+			{
+				OutMatches.Add(ItemIndex);
+			}
+		}
+		SortMatches(Query.SortMode, OutMatches);
+		return;
+	}
+
+	// Check each chunk on its own worker, then stitch the chunks back together to keep the candidate order.
+	const int32 NumChunks = FMath::DivideAndRoundUp(Candidates.Num(), MatchChunkSize);
+	TArray<TArray<int32>> ChunkMatches;
+	ChunkMatches.SetNum(NumChunks);
+	ParallelFor(NumChunks, [&Candidates, &ChunkMatches, &IsMatch](const int32 ChunkIndex)
+	{
+		const int32 First = ChunkIndex * MatchChunkSize;
+		const int32 Last = FMath::Min(First + MatchChunkSize, Candidates.Num());
+		TArray<int32>& Matches = ChunkMatches[ChunkIndex];
+		Matches.Reserve(Last - First);
+		for (int32 CandidateIndex = First; CandidateIndex < Last; ++CandidateIndex)
+		{
+			if (IsMatch(Candidates[CandidateIndex]))
+			{
+				Matches.Add(Candidates[CandidateIndex]);
+			}
+		}
+	});
+
+	int32 NumMatches = 0;
+	for (const TArray<int32>& Matches : ChunkMatches)
+	{
+		NumMatches += Matches.Num();
+	}
+	OutMatches.Reserve(NumMatches);
+	for (const TArray<int32>& Matches : ChunkMatches)
+	{
+		OutMatches.Append(Matches);
+	}
+	SortMatches(Query.SortMode, OutMatches);
+}
+
+void FStoreCatalogIndex::CountFacets(const FStoreFilterQuery& Query, FStoreFacetCounts& OutFacets) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	OutFacets.Reset(CategoryIndex.NumTags());
+
+	if (Query.FoldedText.IsEmpty())
+	{
+		for (int32 ItemIndex = 0; ItemIndex < Num(); ++ItemIndex)
+		{
+			if (Columns.IsAvailable(ItemIndex))
+			{
+				AdjustFacets(ItemIndex, 1, OutFacets);
+			}
+		}
+		return;
+	}
+
+	if (Query.SearchMode == EStoreSearchMode::Fuzzy)
+	{
+		// Every fuzzy match counts, not only the MaxFuzzyResults best, so there is nothing to rank.
+		const FStoreFuzzyIndex::FQuery FuzzyQuery = FStoreFuzzyIndex::PrepareQuery(Query.FoldedText);
+		for (int32 ItemIndex = 0; ItemIndex < Num(); ++ItemIndex)
+		{
+			int32 Score = 0;
+			if (Columns.IsAvailable(ItemIndex) && FuzzyIndex.Score(ItemIndex, FuzzyQuery, Score))
+			{
+				AdjustFacets(ItemIndex, 1, OutFacets);
+			}
+		}
+		return;
+	}
+
+	TArray<int32> TextMatches;
+	TextIndex.GatherCandidates(Query.FoldedText, TextMatches);
+	TextMatches.RemoveAll([this, &Query](const int32 ItemIndex)
+	{
+		return !Columns.IsAvailable(ItemIndex) || !TextIndex.ItemMatches(ItemIndex, Query.FoldedText);
+	});
+	for (const int32 ItemIndex : TextMatches)
+	{
+		AdjustFacets(ItemIndex, 1, OutFacets);
+	}
+}
+
+bool FStoreCatalogIndex::MatchesText(const FStoreFilterQuery& Query, const int32 ItemIndex) const
+{
+	if (Query.FoldedText.IsEmpty())
+	{
+		return true;
+	}
+	if (Query.SearchMode == EStoreSearchMode::Fuzzy)
+	{
+		int32 Score = 0;
+		return FuzzyIndex.Score(ItemIndex, FStoreFuzzyIndex::PrepareQuery(Query.FoldedText), Score);
+	}
+	return TextIndex.ItemMatches(ItemIndex, Query.FoldedText);
+}
+
+void FStoreCatalogIndex::AdjustFacets(const int32 ItemIndex, const int32 Delta, FStoreFacetCounts& InOutFacets) const
+{
+	InOutFacets.Total += Delta;
+	for (const int32 TagId : CategoryIndex.GetItemTagIds(ItemIndex))
+	{
+		InOutFacets.CountsByTag[TagId] += Delta;
+	}
+}
+
+void FStoreCatalogIndex::MatchFuzzy(const FStoreFilterQuery& Query, const FMolecularBitmap& CategoryMatches, const uint64 CategoryMask, TArray<int32>& OutMatches, FStoreFacetCounts* OutFacets) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	using namespace StoreCatalogIndex_private;
+
+	// Typos break trigrams, so the text index can't narrow the candidates. Only the category, cost and availability filters can.
+	const bool bCheckCost = Query.HasCostRange();
+	const bool bUseCategoryMask = Columns.HasExactCategoryMasks();
+	auto IsInCategory = [this, &Query, &CategoryMatches, CategoryMask, bUseCategoryMask](const int32 ItemIndex)
+	{
+		return Query.bAnyCategory || (bUseCategoryMask ? Columns.MatchesCategoryMask(ItemIndex, CategoryMask) : CategoryMatches.Contains(ItemIndex));
+	};
+	auto IsCandidate = [this, &Query, bCheckCost](const int32 ItemIndex)
+	{
+		return Columns.IsAvailable(ItemIndex) && (!bCheckCost || Columns.IsCostInRange(ItemIndex, Query.MinCost, Query.MaxCost));
+	};
+
+	const FStoreFuzzyIndex::FQuery FuzzyQuery = FStoreFuzzyIndex::PrepareQuery(Query.FoldedText);
+	FBestScores Kept(Query.MaxFuzzyResults, Query.bAnyCategory || OutFacets != nullptr ? Num() : CategoryMatches.Num());
+	auto ScoreCandidate = [this, &FuzzyQuery, &Kept, &IsCandidate](const int32 ItemIndex)
+	{
+		int32 Score = 0;
+		if (IsCandidate(ItemIndex) && FuzzyIndex.Score(ItemIndex, FuzzyQuery, Score))
+		{
+			Kept.Add(Score, ItemIndex);
+		}
+	};
+
+	if (OutFacets != nullptr)
+	{
+		// The facets count every available item the text matches, whatever its category or cost, so every one is scored
+		// anyway. The same pass keeps the ones the other filters let through.
+		OutFacets->Reset(CategoryIndex.NumTags());
+		for (int32 ItemIndex = 0; ItemIndex < Num(); ++ItemIndex)
+		{
+			int32 Score = 0;
+			if (!Columns.IsAvailable(ItemIndex) || !FuzzyIndex.Score(ItemIndex, FuzzyQuery, Score))
+			{
+				continue;
+			}
+			AdjustFacets(ItemIndex, 1, *OutFacets);
+			if ((!bCheckCost || Columns.IsCostInRange(ItemIndex, Query.MinCost, Query.MaxCost)) && IsInCategory(ItemIndex))
+			{
+				Kept.Add(Score, ItemIndex);
+			}
+		}
+	}
+	else if (Query.bAnyCategory)
+	{
+		for (int32 ItemIndex = 0; ItemIndex < Num(); ++ItemIndex)
+		{
+			ScoreCandidate(ItemIndex);
+		}
+	}
+	else
+	{
+		CategoryMatches.ForEach(ScoreCandidate);
+	}
+
+	Kept.Finish(OutMatches);
+}
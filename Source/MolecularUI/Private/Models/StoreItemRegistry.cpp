@@ -0,0 +1,55 @@
+// Copyright Mike Desrosiers, All Rights Reserved.
+
+#include "Models/StoreItemRegistry.h"
+
+FStoreItemHandle FStoreItemRegistry::FindOrAdd(const FName ItemId)
+{
+	if (ItemId.IsNone())
+	{
+		return FStoreItemHandle();
+	}
+	if (const int32* Index = IndexById.Find(ItemId))
+	{
+		return FStoreItemHandle(*Index, Slots[*Index].Generation);
+	}
+
+	const int32 Index = !FreeIndices.IsEmpty() ? FreeIndices.Pop(EAllowShrinking::No) : Slots.AddDefaulted();
+	Slots[Index].ItemId = ItemId;
+	IndexById.Add(ItemId, Index);
+	return FStoreItemHandle(Index, Slots[Index].Generation);
+}
+
+FStoreItemHandle FStoreItemRegistry::Find(const FName ItemId) const
+{
+	const int32* Index = IndexById.Find(ItemId);
+	return Index != nullptr ? FStoreItemHandle(*Index, Slots[*Index].Generation) : FStoreItemHandle();
+}
+
+void FStoreItemRegistry::Release(const FStoreItemHandle Handle)
+{
+	if (!IsValid(Handle))
+	{
+		return;
+	}
+	FSlot& Slot = Slots[Handle.Index];
+	IndexById.Remove(Slot.ItemId);
+	Slot.ItemId = NAME_None;
+	++Slot.Generation;
+	FreeIndices.Add(Handle.Index);
+}
+
+void FStoreItemRegistry::Reset()
+{
+	FreeIndices.Reset();
+	for (int32 Index = Slots.Num() - 1; Index >= 0; --Index)
+	{
+		FSlot& Slot = Slots[Index];
+		if (!Slot.ItemId.IsNone())
+		{
+			Slot.ItemId = NAME_None;
+			++Slot.Generation;
+		}
+		FreeIndices.Add(Index);
+	}
+	IndexById.Reset();
+}
@@ -4,6 +4,14 @@
 
 #include <MVVMGameSubsystem.h>
 #include <TimerManager.h>
+#include <Algo/Sort.h>
+#include <Algo/Unique.h>
+#include <Async/Async.h>
+#include <Engine/AssetManager.h>
+#include <Engine/StreamableManager.h>
+#include <Engine/World.h>
+#include <Internationalization/Internationalization.h>
+#include <Tasks/Task.h>
 
 #include "ViewModels/StoreViewModel.h"
 #include "ViewModels/ItemViewModel.h"
@@ -11,8 +19,11 @@
 #include "MolecularUITags.h"
 #include "Utils/LogMolecularUI.h"
 #include "DataProviders/MockStoreDataProviderSubsystem.h"
+#include "DataProviders/StoreDataProviderMultiplexer.h"
+#include "MolecularUISettings.h"
 #include "ViewModels/CategoryViewModel.h"
 #include "ViewModels/SelectionViewModel.h"
+#include "ViewModels/WindowedCollectionViewModel.h"
 
 namespace UStoreSubsystem_private
 {
@@ -66,9 +77,17 @@ void UStoreModel::InitializeModel_Implementation(UWorld* World)
 	if (IsValid(StoreDataProviderSubsystem)
 		&& StoreDataProviderSubsystem->GetClass()->ImplementsInterface(UStoreDataProvider::StaticClass()))
 	{
-		StoreDataProviderInterface.SetObject(StoreDataProviderSubsystem);
-		StoreDataProviderInterface.SetInterface(Cast<IStoreDataProvider>(StoreDataProviderSubsystem));
+		TScriptInterface<IStoreDataProvider> InnerProvider;
+		InnerProvider.SetObject(StoreDataProviderSubsystem);
+		InnerProvider.SetInterface(Cast<IStoreDataProvider>(StoreDataProviderSubsystem));
+
+		// Every fetch goes through the multiplexer, so overlapping loads share a request instead of cancelling each other.
+		StoreDataProviderMultiplexer = NewObject<UStoreDataProviderMultiplexer>(this);
+		StoreDataProviderMultiplexer->SetInnerProvider(InnerProvider);
+		StoreDataProviderInterface.SetObject(StoreDataProviderMultiplexer);
+		StoreDataProviderInterface.SetInterface(Cast<IStoreDataProvider>(StoreDataProviderMultiplexer));
 	}
+	RefreshBucket = FMolecularTokenBucket(RefreshBurstLimit, RefreshTokensPerSecond);
 
 	StoreViewModelCollection = NewObject<UMVVMViewModelCollectionObject>(this, UMVVMViewModelCollectionObject::StaticClass());
 
@@ -83,16 +102,16 @@ void UStoreModel::InitializeModel_Implementation(UWorld* World)
 			StoreViewModel);
 	}
 
+	ResolveCategoryUIData();
+
 	// Add default category tabs for the available items list.
 	TArray<UCategoryViewModel*> CategoryTabViewModels_AvailableItems;
 	for (const FCategoryTabDefinition& CategoryTab : DefaultCategoryTabs_AvailableItems)
 	{
-		UCategoryViewModel* CategoryVM = NewObject<UCategoryViewModel>(StoreViewModel);
-		CategoryVM->SetCategoryTag(CategoryTab.CategoryTag);
+		// Interned like any other category, so items with this tag share the tab's UI data.
+		UCategoryViewModel* CategoryVM = GetOrCreateCategoryViewModel(CategoryTab.CategoryTag);
 		CategoryVM->SetUIData(CategoryTab.UIData);
-
-		UE_MVVM_BIND_FIELD(UCategoryViewModel, CategoryVM, Interaction, OnItemCategoryInteractionChanged);
-		CategoryTabViewModels_AvailableItems.Add(CategoryVM);
+		CategoryTabViewModels_AvailableItems.AddUnique(CategoryVM);
 	}
 	StoreViewModel->SetCategoryTabs_AvailableItems(CategoryTabViewModels_AvailableItems);
 	if (!CategoryTabViewModels_AvailableItems.IsEmpty())
@@ -108,9 +127,33 @@ void UStoreModel::InitializeModel_Implementation(UWorld* World)
 		FMVVMViewModelContext(USelectionViewModel::StaticClass(), SelectionViewModel_Store_Name),
 		SelectionViewModel_Store);
 
+	// Windowed views of the item lists, for views that only want the entries on screen.
+	if (!IsValid(AvailableItemsWindow))
+	{
+		AvailableItemsWindow = NewObject<UWindowedCollectionViewModel>(this);
+	}
+	if (!IsValid(OwnedItemsWindow))
+	{
+		OwnedItemsWindow = NewObject<UWindowedCollectionViewModel>(this);
+	}
+	StoreViewModelCollection->AddViewModelInstance(
+		FMVVMViewModelContext(UWindowedCollectionViewModel::StaticClass(), AvailableItemsWindow_Name),
+		AvailableItemsWindow);
+	StoreViewModelCollection->AddViewModelInstance(
+		FMVVMViewModelContext(UWindowedCollectionViewModel::StaticClass(), OwnedItemsWindow_Name),
+		OwnedItemsWindow);
+
+	FInternationalization::Get().OnCultureChanged().AddUObject(this, &UStoreModel::HandleCultureChanged);
+
 	UE_MVVM_BIND_FIELD(UStoreViewModel, StoreViewModel, FilterText, OnFilterTextChanged);
+	UE_MVVM_BIND_FIELD(UStoreViewModel, StoreViewModel, MinCostFilter, OnCostFilterChanged);
+	UE_MVVM_BIND_FIELD(UStoreViewModel, StoreViewModel, MaxCostFilter, OnCostFilterChanged);
+	UE_MVVM_BIND_FIELD(UStoreViewModel, StoreViewModel, SearchMode, OnSearchModeChanged);
+	UE_MVVM_BIND_FIELD(UStoreViewModel, StoreViewModel, SortMode, OnSortModeChanged);
 	UE_MVVM_BIND_FIELD(UStoreViewModel, StoreViewModel, TransactionRequest, OnTransactionRequestChanged);
 	UE_MVVM_BIND_FIELD(UStoreViewModel, StoreViewModel, bRefreshRequested, OnRefreshRequestedChanged);
+	UE_MVVM_BIND_FIELD(UWindowedCollectionViewModel, AvailableItemsWindow, VisibleRange, OnItemWindowRangeChanged);
+	UE_MVVM_BIND_FIELD(UWindowedCollectionViewModel, OwnedItemsWindow, VisibleRange, OnItemWindowRangeChanged);
 }
 
 void UStoreModel::DeinitializeModel_Implementation()
@@ -118,46 +161,89 @@ void UStoreModel::DeinitializeModel_Implementation()
 	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
 
 	UE_MVVM_UNBIND_FIELD(StoreViewModel, FilterText);
+	UE_MVVM_UNBIND_FIELD(StoreViewModel, MinCostFilter);
+	UE_MVVM_UNBIND_FIELD(StoreViewModel, MaxCostFilter);
+	UE_MVVM_UNBIND_FIELD(StoreViewModel, SearchMode);
+	UE_MVVM_UNBIND_FIELD(StoreViewModel, SortMode);
 	UE_MVVM_UNBIND_FIELD(StoreViewModel, TransactionRequest);
 	UE_MVVM_UNBIND_FIELD(StoreViewModel, bRefreshRequested);
+	UE_MVVM_UNBIND_FIELD(AvailableItemsWindow, VisibleRange);
+	UE_MVVM_UNBIND_FIELD(OwnedItemsWindow, VisibleRange);
 
 	if (GetWorld())
 	{
 		GetWorld()->GetTimerManager().ClearAllTimersForObject(this);
 	}
+	FWorldDelegates::OnWorldPostActorTick.Remove(PendingFilterHandle);
+	PendingFilterHandle.Reset();
+	FInternationalization::Get().OnCultureChanged().RemoveAll(this);
+
+	for (const TSharedPtr<FStreamableHandle>& Handle : CategoryIconLoadHandles)
+	{
+		if (Handle.IsValid())
+		{
+			Handle->CancelHandle();
+		}
+	}
+	CategoryIconLoadHandles.Empty();
 
 	if (IsValid(StoreViewModelCollection))
 	{
 		StoreViewModelCollection->RemoveAllViewModelInstance(StoreViewModel);
 		StoreViewModelCollection->RemoveAllViewModelInstance(SelectionViewModel_Store);
 		StoreViewModelCollection->RemoveAllViewModelInstance(SelectionViewModel_Store_Tabs);
+		StoreViewModelCollection->RemoveAllViewModelInstance(AvailableItemsWindow);
+		StoreViewModelCollection->RemoveAllViewModelInstance(OwnedItemsWindow);
 	}
 
 	// Unbind any field notifications from the ItemViewModel.
-	for (const TTuple<FName, TObjectPtr<UItemViewModel>>& Pair : ItemViewModelCache)
+	for (UItemViewModel* ItemVM : ItemViewModelCache)
 	{
-		UItemViewModel* ItemVM = Pair.Value;
 		if (IsValid(ItemVM))
 		{
 			UE_MVVM_UNBIND_FIELD(ItemVM, Interaction);
-			for (UCategoryViewModel* CategoryVM : ItemVM->GetCategoryViewModels())
-			{
-				UE_MVVM_UNBIND_FIELD(CategoryVM, Interaction);
-			}
 		}
 	}
 
-	for (UCategoryViewModel* CategoryVM : StoreViewModel->GetCategoryTabs_AvailableItems())
+	// Category tabs and the items' categories are all interned here.
+	for (const TTuple<FGameplayTag, TObjectPtr<UCategoryViewModel>>& Pair : CategoryViewModelRegistry)
 	{
-		UE_MVVM_UNBIND_FIELD(CategoryVM, Interaction);
+		UCategoryViewModel* CategoryVM = Pair.Value;
+		if (IsValid(CategoryVM))
+		{
+			UE_MVVM_UNBIND_FIELD(CategoryVM, Interaction);
+		}
 	}
 
 	StoreViewModel = nullptr;
 
 	ItemViewModelCache.Empty();
+	NumCachedItemViewModels = 0;
+	ItemViewModelLastUse.Empty();
+	ItemViewModelPool.Empty();
+	ItemRegistry.Reset();
+	ReloadedStoreItems.Empty();
+	bReloadingStoreItems = false;
+	LoadedPageHandles.Empty();
+	CategoryViewModelRegistry.Empty();
+	ResolvedCategoryUIData.Empty();
 	CachedStoreItems.Empty();
+	CachedOwnedItems.Empty();
+	OwnedItemsSnapshot.Reset();
+	CatalogIndex.Reset();
+	LastFilterMatches.Empty();
+	++(*FilterGeneration); // Drop any filter result still in flight.
+	++StoreItemsFetchSerial; // And any catalog page.
+	KnownStoreVersion = INDEX_NONE;
+	PendingTransactions.Empty();
+	bLoadingStoreItemPages = false;
+	bStoreChangesPending = false;
+	bHasLastFilterResult = false;
+	bHasFacetCounts = false;
 
 	StoreDataProviderInterface = nullptr;
+	StoreDataProviderMultiplexer = nullptr;
+	TrailingRefreshHandle.Invalidate();
 
 	Super::DeinitializeModel_Implementation();
 }
@@ -195,13 +281,33 @@ UMVVMViewModelBase* UStoreModel::GetViewModel_Implementation(FMVVMViewModelConte
 void UStoreModel::OnFilterTextChanged_Implementation(UStoreViewModel* InStoreViewModel, FFieldNotificationId Field)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(__FUNCTION__);
-	FilterAvailableStoreItems();
+	RequestFilterAvailableStoreItems(/*bDebounce*/ true);
+}
+
+void UStoreModel::OnCostFilterChanged_Implementation(UStoreViewModel* InStoreViewModel, FFieldNotificationId Field)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	// Dragging a price slider changes the bounds every frame, treat it like typing.
+	RequestFilterAvailableStoreItems(/*bDebounce*/ true);
+}
+
+void UStoreModel::OnSearchModeChanged_Implementation(UStoreViewModel* InStoreViewModel, FFieldNotificationId Field)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	RequestFilterAvailableStoreItems();
+}
+
+void UStoreModel::OnSortModeChanged_Implementation(UStoreViewModel* InStoreViewModel, FFieldNotificationId Field)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	// The query is unchanged apart from its order, so the pass refines the previous matches and only re-sorts them.
+	RequestFilterAvailableStoreItems();
 }
 
 void UStoreModel::OnSelectedCategoriesChanged_Implementation(UStoreViewModel* InStoreViewModel, FFieldNotificationId Field)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(__FUNCTION__);
-	FilterAvailableStoreItems();
+	RequestFilterAvailableStoreItems();
 }
 
 void UStoreModel::OnTransactionRequestChanged_Implementation(UStoreViewModel* InStoreViewModel, FFieldNotificationId Field)
@@ -218,7 +324,7 @@ void UStoreModel::OnTransactionRequestChanged_Implementation(UStoreViewModel* In
 	}
 
 	// If the store isn't ready, reset the request and exit early.
-	if (!InStoreViewModel->HasStoreState(MolecularUITags::Store::State::Ready))
+	if (!CanStartTransaction())
 	{
 		UE_LOG(LogMolecularUI, Log, TEXT("[%hs] Store not ready. Failing transaction request for %s"), __FUNCTION__,
 			   *TransactionRequest.ToString());
@@ -254,9 +360,9 @@ void UStoreModel::OnRefreshRequestedChanged_Implementation(UStoreViewModel* InSt
 	{
 		InStoreViewModel->SetRefreshRequested(false); // Reset the flag
 
-		RefreshStoreData();
-		
 		UE_LOG(LogMolecularUI, Log, TEXT("[%hs] Refresh requested. Reloading store data."), __FUNCTION__);
+
+		RequestRefreshStoreData();
 	}
 }
 
@@ -276,12 +382,14 @@ void UStoreModel::OnItemInteractionChanged_Implementation(UItemViewModel* InItem
 	
 	const FString& SourceName = Interaction.Source.ToString();
 
+	const FStoreItem& ItemData = InItemVM->GetItemData();
+
 	// Handle the interaction based on its type
 	switch (Interaction.Type)
 	{
 	case EStatefulInteraction::Hovered:
 		{
-			const FString& ItemName = InItemVM->GetItemData().UIData.DisplayName.ToString();
+			const FString& ItemName = ItemData.UIData.DisplayName.ToString();
 			StoreViewModel->SetStatusMessage(FText::Format(
 				FText::FromString("Previewing item: {0} (from {1})"),
 				FText::FromString(ItemName), FText::FromString(SourceName)));
@@ -296,7 +404,7 @@ void UStoreModel::OnItemInteractionChanged_Implementation(UItemViewModel* InItem
 		}
 	case EStatefulInteraction::Clicked:
 		{
-			const FString& ItemName = InItemVM->GetItemData().UIData.DisplayName.ToString();
+			const FString& ItemName = ItemData.UIData.DisplayName.ToString();
 			StoreViewModel->SetStatusMessage(FText::Format(
 				FText::FromString("Clicked on item: {0} (from {1})"),
 				FText::FromString(ItemName), FText::FromString(SourceName)));
@@ -305,19 +413,19 @@ void UStoreModel::OnItemInteractionChanged_Implementation(UItemViewModel* InItem
 			const UItemViewModel* LastSelectedVM = Cast<UItemViewModel>(SelectionViewModel_Store->GetLastSelectedViewModel());
 			if (IsValid(LastSelectedVM))
 			{
-				if (LastSelectedVM->GetItemData().bIsOwned != InItemVM->GetItemData().bIsOwned)
+				if (LastSelectedVM->GetItemData().bIsOwned != ItemData.bIsOwned)
 				{
 					SelectionViewModel_Store->ClearSelection();
 				}
 			}
 			SelectionViewModel_Store->ToggleSelectViewModel(InItemVM);
 			
-			if (InItemVM->GetItemData().bIsOwned)
+			if (ItemData.bIsOwned)
 			{
 				// Passes the "client-side" check that the item can be sold.
 				StoreViewModel->SetTransactionType(ETransactionType::Sell);
 			}
-			else if (InItemVM->GetItemData().Cost <= StoreViewModel->GetPlayerCurrency())
+			else if (ItemData.Cost <= StoreViewModel->GetPlayerCurrency())
 			{
 				// Passes the "client-side" check that the item can be purchased.
 				StoreViewModel->SetTransactionType(ETransactionType::Purchase);
@@ -360,6 +468,13 @@ void UStoreModel::OnItemCategoryInteractionChanged_Implementation(UCategoryViewM
 	case EStatefulInteraction::None:
 		break;
 	case EStatefulInteraction::Hovered:
+		{
+			// The tab list shows the category itself. Anywhere else it is shown on behalf of an item, so describe it.
+			if (!Interaction.Source.MatchesTag(MolecularUITags::InteractionSource::TabList))
+			{
+				StoreViewModel->SetStatusMessage(InCategoryVM->GetUIData().Description);
+			}
+		}
 		break;
 	case EStatefulInteraction::Unhovered:
 		{
@@ -378,7 +493,14 @@ void UStoreModel::OnItemCategoryInteractionChanged_Implementation(UCategoryViewM
 					FText::FromString(CategoryTag),
 					FText::FromString(Interaction.ToString())
 				));
-				FilterAvailableStoreItems();
+				RequestFilterAvailableStoreItems();
+			}
+			else if (StoreViewModel->GetCategoryTabs_AvailableItems().Contains(InCategoryVM)
+				&& !SelectionViewModel_Store_Tabs->IsViewModelSelected(InCategoryVM))
+			{
+				// Clicking an item's category jumps to that tab. The item selection is kept, unlike a tab switch.
+				SelectionViewModel_Store_Tabs->ToggleSelectViewModel(InCategoryVM);
+				RequestFilterAvailableStoreItems();
 			}
 		}
 		break;
@@ -387,62 +509,301 @@ void UStoreModel::OnItemCategoryInteractionChanged_Implementation(UCategoryViewM
 	InCategoryVM->ClearInteraction();
 }
 
+void UStoreModel::OnItemWindowRangeChanged_Implementation(UWindowedCollectionViewModel* InWindowVM, FFieldNotificationId Field)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	if (InWindowVM == AvailableItemsWindow)
+	{
+		RefreshAvailableItemsWindow(/*bForce*/ false);
+	}
+	else if (InWindowVM == OwnedItemsWindow)
+	{
+		RefreshOwnedItemsWindow(/*bForce*/ false);
+	}
+	TrimItemViewModelCache();
+}
+
 /* Lazy Loading Functions */
 void UStoreModel::LazyLoadStoreItems_Implementation()
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
 	SCOPED_STORE_STATE(LoadingScope, StoreViewModel, MolecularUITags::Store::State::Loading::Items);
 
-	auto OnSuccess = [this, LoadingScope](const TArray<FStoreItem>& Items, const FText& Status)
+	if (!StoreDataProviderInterface)
+	{
+		return;
+	}
+
+	// Each page requests the next one. The request function holds the loading state, so it is cleared once the
+	// last page or a failure lets go of it.
+	const uint32 FetchSerial = ++StoreItemsFetchSerial;
+	bLoadingStoreItemPages = true;
+	TSharedRef<TFunction<void(const FString&)>> FetchPage = MakeShared<TFunction<void(const FString&)>>();
+	*FetchPage = [this, LoadingScope, FetchSerial, WeakFetchPage = TWeakPtr<TFunction<void(const FString&)>>(FetchPage)](const FString& Cursor)
 	{
 		(void)LoadingScope;
-		CachedStoreItems = Items;
-		TArray<TObjectPtr<UItemViewModel>> StoreItems;
-		StoreItems.Reserve(Items.Num());
+		TSharedPtr<TFunction<void(const FString&)>> FetchNextPage = WeakFetchPage.Pin();
+		const bool bFirstPage = Cursor.IsEmpty();
 
-		for (const FStoreItem& ItemData : Items)
+		auto OnPage = [this, FetchSerial, FetchNextPage, bFirstPage](FStoreItemPage&& Page, const FText& Status)
 		{
-			UItemViewModel* ItemVM = GetOrCreateItemViewModel(ItemData);
-			StoreItems.AddUnique(ItemVM);
-		}
+			if (FetchSerial != StoreItemsFetchSerial)
+			{
+				return; // Superseded by a newer fetch, or the model was deinitialized.
+			}
+			const FString NextCursor = Page.NextCursor;
+			AppendStoreItemsPage(MoveTemp(Page), bFirstPage);
+			StoreViewModel->SetStatusMessage(Status);
+			if (!NextCursor.IsEmpty())
+			{
+				(*FetchNextPage)(NextCursor);
+				return;
+			}
 
-		StoreViewModel->SetAvailableItems(StoreItems);
-		FilterAvailableStoreItems();
-		StoreViewModel->SetStatusMessage(Status);
+			bLoadingStoreItemPages = false;
+			if (bStoreChangesPending)
+			{
+				SyncStoreChanges();
+			}
+		};
+
+		auto OnFailure = [this, FetchSerial, FetchNextPage](const FText& Error)
+		{
+			if (FetchSerial != StoreItemsFetchSerial)
+			{
+				return;
+			}
+			UE_LOG(LogMolecularUI, Warning, TEXT("[%hs] Failure loading store items."), __FUNCTION__);
+			bLoadingStoreItemPages = false;
+			bStoreChangesPending = false; // The next refresh fetches everything anyway.
+			if (bReloadingStoreItems)
+			{
+				// The previous catalog stays published until the next refresh.
+				bReloadingStoreItems = false;
+				DiscardReloadedStoreItems();
+			}
+			else if (CatalogIndex.IsValid() && !CatalogIndex->HasOrderings())
+			{
+				// The pages received so far are all there will be until the next refresh.
+				AppendToCatalogIndex(/*bBuildOrderings*/ true);
+				RequestFilterAvailableStoreItems();
+			}
+			LoadedPageHandles.Empty();
+			StoreViewModel->SetErrorMessage(Error);
+			StoreViewModel->AddStoreState(MolecularUITags::Store::State::Error);
+		};
+
+		StoreDataProviderInterface->FetchStoreItemsPage(Cursor, StoreItemsPageSize, OnPage, OnFailure);
 	};
+	(*FetchPage)(FString());
+}
 
-	auto OnFailure = [this, LoadingScope](const FText& Error)
+void UStoreModel::AppendStoreItemsPage(FStoreItemPage&& Page, const bool bFirstPage)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	if (bFirstPage)
 	{
-		(void)LoadingScope;
-		UE_LOG(LogMolecularUI, Warning, TEXT("[%hs] Failure loading store items."), __FUNCTION__);
-		StoreViewModel->SetErrorMessage(Error);
-		StoreViewModel->AddStoreState(MolecularUITags::Store::State::Error);
-	};
+		// A reload keeps the previous catalog published, with its window, selection, histogram and counts, and swaps
+		// the new one in at the last page. Only the first load shows its pages as they come, with nothing to keep.
+		DiscardReloadedStoreItems(); // Pages of a reload this one overtook.
+		bReloadingStoreItems = !CachedStoreItems.IsEmpty();
+		LoadedPageHandles.Init(false, ItemRegistry.GetMaxIndex());
+
+		// Later pages can be read at newer versions. Syncing from the first page's version covers them all.
+		if (bReloadingStoreItems)
+		{
+			ReloadedStoreVersion = Page.Version;
+		}
+		else
+		{
+			KnownStoreVersion = Page.Version;
+			CatalogIndex.Reset();
+			++(*FilterGeneration); // Results still in flight index the previous catalog.
+			LastFilterMatches.Reset();
+			bHasLastFilterResult = false;
+		}
+	}
 
-	if (StoreDataProviderInterface)
+	TArray<FStoreItem>& Items = bReloadingStoreItems ? ReloadedStoreItems : CachedStoreItems;
+	const int32 FirstNewItem = Items.Num();
+	Items.Append(MoveTemp(Page.Items));
+	AssignItemHandles(MakeArrayView(Items).RightChop(FirstNewItem));
+	DropRepeatedItems(Items, FirstNewItem);
+	const TArrayView<FStoreItem> NewItems = MakeArrayView(Items).RightChop(FirstNewItem);
+	StampContentHashes(NewItems);
+	const bool bLastPage = Page.NextCursor.IsEmpty();
+	if (bLastPage)
+	{
+		LoadedPageHandles.Empty();
+	}
+
+	if (bReloadingStoreItems)
+	{
+		if (bLastPage)
+		{
+			bReloadingStoreItems = false;
+			SwapInReloadedStoreItems();
+		}
+		return;
+	}
+
+	AppendToCatalogIndex(/*bBuildOrderings*/ bLastPage);
+	SyncCategoryTabs(NewItems);
+
+	// ItemViewModels are created by the filter pass for what it publishes, not for every row of the page.
+	RequestFilterAvailableStoreItems();
+}
+
+void UStoreModel::SwapInReloadedStoreItems()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	// The previous matches follow their items to the new rows, so the window keeps showing them, and the selection
+	// and the list's delta channel keep their rows, until the refilter lands.
+	TArray<FStoreItemHandle> MatchedHandles;
+	MatchedHandles.Reserve(LastFilterMatches.Num());
+	for (const int32 ItemIndex : LastFilterMatches)
+	{
+		MatchedHandles.Add(CachedStoreItems[ItemIndex].Handle);
+	}
+	TArray<FStoreItemHandle> PreviousHandles;
+	PreviousHandles.Reserve(CachedStoreItems.Num());
+	for (const FStoreItem& Item : CachedStoreItems)
+	{
+		PreviousHandles.Add(Item.Handle);
+	}
+
+	CachedStoreItems = MoveTemp(ReloadedStoreItems);
+	ReloadedStoreItems.Reset();
+	KnownStoreVersion = ReloadedStoreVersion;
+	SyncCategoryTabs(CachedStoreItems);
+	CatalogIndex.Reset(); // Nothing of the previous catalog's rows carries over.
+	LastFilterMatches.Reset();
+	RebuildCatalogIndex();
+	for (const FStoreItemHandle& Handle : MatchedHandles)
+	{
+		const int32 ItemIndex = CatalogIndex->FindItemIndex(Handle);
+		if (ItemIndex != INDEX_NONE && CatalogIndex->Columns.IsAvailable(ItemIndex))
+		{
+			LastFilterMatches.Add(ItemIndex);
+		}
+	}
+
+	// The pages can predate transactions still in flight, which stay projected until they settle.
+	FStoreChangeSet Projections;
+	for (const FPendingTransaction& Pending : PendingTransactions)
 	{
-		StoreDataProviderInterface->FetchStoreItems(OnSuccess, OnFailure);
+		MergeChangeSets(Projections, Pending.Projection);
 	}
+	ApplyItemListChanges(MoveTemp(Projections));
+
+	RefreshAvailableItemsWindow(/*bForce*/ true);
+	ReleaseItemHandlesIfUnused(PreviousHandles);
 }
 
-void UStoreModel::LazyLoadOwnedItems_Implementation()
+void UStoreModel::DiscardReloadedStoreItems()
+{
+	if (ReloadedStoreItems.IsEmpty())
+	{
+		return;
+	}
+	TArray<FStoreItemHandle> ReloadedHandles;
+	ReloadedHandles.Reserve(ReloadedStoreItems.Num());
+	for (const FStoreItem& Item : ReloadedStoreItems)
+	{
+		ReloadedHandles.Add(Item.Handle);
+	}
+	ReloadedStoreItems.Empty();
+	ReleaseItemHandlesIfUnused(ReloadedHandles);
+}
+
+void UStoreModel::DropRepeatedItems(TArray<FStoreItem>& Items, const int32 FirstNewItem)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
-	SCOPED_STORE_STATE(LoadingScope, StoreViewModel, MolecularUITags::Store::State::Loading::OwnedItems);
 
-	auto OnSuccess = [this, LoadingScope](const TArray<FStoreItem>& Items, const FText& Status)
+	// Handles are dense, so a bit per handle is the whole set of items the fetch has listed so far.
+	if (LoadedPageHandles.Num() < ItemRegistry.GetMaxIndex())
 	{
-		(void)LoadingScope;
-		TArray<TObjectPtr<UItemViewModel>> OwnedItemVMs;
-		OwnedItemVMs.Reserve(Items.Num());
+		LoadedPageHandles.Add(false, ItemRegistry.GetMaxIndex() - LoadedPageHandles.Num());
+	}
+	int32 WriteIndex = FirstNewItem;
+	for (int32 ReadIndex = FirstNewItem; ReadIndex < Items.Num(); ++ReadIndex)
+	{
+		const FStoreItemHandle Handle = Items[ReadIndex].Handle;
+		if (Handle.IsValid())
+		{
+			if (LoadedPageHandles[Handle.Index])
+			{
+				continue;
+			}
+			LoadedPageHandles[Handle.Index] = true;
+		}
+		if (WriteIndex != ReadIndex)
+		{
+			Items[WriteIndex] = MoveTemp(Items[ReadIndex]);
+		}
+		++WriteIndex;
+	}
+	Items.SetNum(WriteIndex, EAllowShrinking::No);
+}
+
+void UStoreModel::IngestOwnedItems(const TSharedRef<const FStoreCatalogSnapshot>& Snapshot)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	if (OwnedItemsSnapshot == Snapshot)
+	{
+		return; // Nothing changed on the provider's side, or here, since the last copy.
+	}
+	OwnedItemsSnapshot = Snapshot;
 
-		for (const FStoreItem& OwnedItemData : Items)
-		 {
-			UItemViewModel* ItemVM = GetOrCreateItemViewModel(OwnedItemData);
-			OwnedItemVMs.AddUnique(ItemVM);
+	TArray<FStoreItemHandle> PreviousHandles;
+	PreviousHandles.Reserve(CachedOwnedItems.Num());
+	for (const FStoreItem& Item : CachedOwnedItems)
+	{
+		PreviousHandles.Add(Item.Handle);
+	}
+
+	// The snapshot is shared and immutable, and the model stamps handles on its rows, so they can't be taken over.
+	// Rows whose content is unchanged are moved over from the previous list instead, so a refresh that changed a few
+	// items copies those rows and one array, not every row.
+	TArray<FStoreItem> NewItems;
+	NewItems.Reserve(Snapshot->Items.Num());
+	for (int32 ItemIndex = 0; ItemIndex < Snapshot->Items.Num(); ++ItemIndex)
+	{
+		const FStoreItem& Row = Snapshot->Items[ItemIndex];
+		FStoreItem* PreviousRow = CachedOwnedItems.IsValidIndex(ItemIndex) ? &CachedOwnedItems[ItemIndex] : nullptr;
+		if (PreviousRow != nullptr && PreviousRow->ItemId == Row.ItemId && PreviousRow->ContentHash == Row.ContentHash && Row.ContentHash != 0)
+		{
+			NewItems.Add(MoveTemp(*PreviousRow));
+		}
+		else
+		{
+			NewItems.Add(Row);
 		}
+	}
+	CachedOwnedItems = MoveTemp(NewItems);
+	StampContentHashes(CachedOwnedItems);
+	AssignItemHandles(CachedOwnedItems);
+	ReleaseItemHandlesIfUnused(PreviousHandles);
+	RefreshOwnedItemsWindow(/*bForce*/ true);
+
+	if (bPublishFullItemLists)
+	{
+		StoreViewModel->SetOwnedItems(GetOrCreateItemViewModels(CachedOwnedItems));
+	}
+	TrimItemViewModelCache();
+}
 
-		StoreViewModel->SetOwnedItems(OwnedItemVMs);
+void UStoreModel::LazyLoadOwnedItems_Implementation()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	SCOPED_STORE_STATE(LoadingScope, StoreViewModel, MolecularUITags::Store::State::Loading::OwnedItems);
+
+	auto OnSuccess = [this, LoadingScope](const TSharedRef<const FStoreCatalogSnapshot>& Snapshot, const FText& Status)
+	{
+		(void)LoadingScope;
+		IngestOwnedItems(Snapshot);
 		StoreViewModel->SetStatusMessage(Status);
 	};
 
@@ -491,142 +852,1001 @@ void UStoreModel::LazyPurchaseItem_Implementation(const FTransactionRequest& Pur
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
 	SCOPED_STORE_STATE(PurchaseScope, StoreViewModel, MolecularUITags::Store::State::Purchasing);
+	if (!StoreDataProviderInterface)
+	{
+		return;
+	}
 
-	auto OnSuccess = [this, PurchaseScope](const FText& Status)
+	// Show the purchase as done right away. The provider's answer confirms or undoes it.
+	const uint32 TransactionId = ProjectTransaction(PurchaseRequest, /*bPurchase*/ true);
+
+	auto OnSuccess = [this, PurchaseScope, TransactionId](const FText& Status)
 	{
 		(void)PurchaseScope;
+		ConfirmTransaction(TransactionId);
+
 		// Clear the transaction request and type after a successful purchase.
 		StoreViewModel->SetTransactionRequest(FTransactionRequest());
 		StoreViewModel->SetTransactionType(ETransactionType::None);
-
-		RefreshStoreData();
+		SelectionViewModel_Store->ClearPreview();
+		SelectionViewModel_Store->ClearSelection();
 
 		StoreViewModel->SetStatusMessage(Status);
 	};
 
-	auto OnFailure = [this, PurchaseScope](const FText& Error)
+	auto OnFailure = [this, PurchaseScope, TransactionId](const FText& Error)
 	{
 		(void)PurchaseScope;
+		RollbackTransaction(TransactionId);
 		StoreViewModel->AddStoreState(MolecularUITags::Store::State::Error);
 		StoreViewModel->SetErrorMessage(Error);
 	};
 
-	if (StoreDataProviderInterface)
-	{
-		StoreDataProviderInterface->PurchaseItem(PurchaseRequest, OnSuccess, OnFailure);
-	}
+	StoreDataProviderInterface->PurchaseItem(PurchaseRequest, OnSuccess, OnFailure);
 }
 
 void UStoreModel::LazySellItem_Implementation(const FTransactionRequest& TransactionRequest)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
 	SCOPED_STORE_STATE(SellScope, StoreViewModel, MolecularUITags::Store::State::Selling);
+	if (!StoreDataProviderInterface)
+	{
+		return;
+	}
 
-	auto OnSuccess = [this, SellScope](const FText& Status)
+	const uint32 TransactionId = ProjectTransaction(TransactionRequest, /*bPurchase*/ false);
+
+	auto OnSuccess = [this, SellScope, TransactionId](const FText& Status)
 	{
 		(void)SellScope;
+		ConfirmTransaction(TransactionId);
+
 		StoreViewModel->SetTransactionRequest(FTransactionRequest());
 		StoreViewModel->SetTransactionType(ETransactionType::None);
-
-		RefreshStoreData();
+		SelectionViewModel_Store->ClearPreview();
+		SelectionViewModel_Store->ClearSelection();
 
 		StoreViewModel->SetStatusMessage(Status);
 	};
 
-	auto OnFailure = [this, SellScope](const FText& Error)
+	auto OnFailure = [this, SellScope, TransactionId](const FText& Error)
 	{
 		(void)SellScope;
+		RollbackTransaction(TransactionId);
 		StoreViewModel->AddStoreState(MolecularUITags::Store::State::Error);
 		StoreViewModel->SetErrorMessage(Error);
 	};
 
-	if (StoreDataProviderInterface)
+	StoreDataProviderInterface->SellItem(TransactionRequest, OnSuccess, OnFailure);
+}
+
+void UStoreModel::SyncStoreChanges_Implementation()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	if (!StoreDataProviderInterface)
+	{
+		return;
+	}
+	if (bLoadingStoreItemPages)
 	{
-		StoreDataProviderInterface->SellItem(TransactionRequest, OnSuccess, OnFailure);
+		bStoreChangesPending = true;
+		return;
+	}
+	bStoreChangesPending = false;
+	if (KnownStoreVersion == INDEX_NONE)
+	{
+		RefreshStoreData();
+		return;
 	}
+
+	SCOPED_STORE_STATE(LoadingScope, StoreViewModel, MolecularUITags::Store::State::Loading::Changes);
+	const uint32 FetchSerial = StoreItemsFetchSerial;
+
+	auto OnSuccess = [this, LoadingScope, FetchSerial](FStoreChangeSet&& Changes, const FText& Status)
+	{
+		(void)LoadingScope;
+		if (FetchSerial != StoreItemsFetchSerial)
+		{
+			return; // A full fetch started since, and it reads everything this would have applied.
+		}
+		if (Changes.bRequiresFullRefresh)
+		{
+			RefreshStoreData();
+			return;
+		}
+		ApplyStoreChanges(MoveTemp(Changes));
+		StoreViewModel->SetStatusMessage(Status);
+	};
+
+	auto OnFailure = [this, LoadingScope](const FText& Error)
+	{
+		(void)LoadingScope;
+		UE_LOG(LogMolecularUI, Warning, TEXT("[%hs] Failure loading store changes."), __FUNCTION__);
+		StoreViewModel->SetErrorMessage(Error);
+		StoreViewModel->AddStoreState(MolecularUITags::Store::State::Error);
+	};
+
+	StoreDataProviderInterface->FetchStoreChanges(KnownStoreVersion, OnSuccess, OnFailure);
 }
 
 /* Utility Functions */
 void UStoreModel::FilterAvailableStoreItems_Implementation()
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
-	if (CachedStoreItems.IsEmpty())
+
+	// Every pass supersedes any result still in flight.
+	const uint32 Generation = ++(*FilterGeneration);
+
+	// Pages that arrived while an async pass held the index are indexed as soon as nothing does.
+	if (CatalogIndex.IsValid() && CatalogIndex.IsUnique() && CatalogIndex->Num() < CachedStoreItems.Num())
+	{
+		AppendToCatalogIndex(/*bBuildOrderings*/ false);
+	}
+
+	if (CachedStoreItems.IsEmpty() || !CatalogIndex.IsValid())
 	{
+		LastFilterMatches.Reset();
+		FacetCounts.Reset(0);
+		bHasFacetCounts = false;
+		RefreshAvailableItemsWindow(/*bForce*/ true);
+		StoreViewModel->SetAvailableItems({});
+		PublishFacetCounts();
+		TrimItemViewModelCache();
 		return;
 	}
 
-	const FString& FilterText = StoreViewModel->GetFilterText();
-	const TArray<UInteractiveViewModelBase*>& SelectedCategories_AvailableItems = SelectionViewModel_Store_Tabs->GetSelectedViewModels();
+	const FStoreFilterQuery Query = MakeFilterQuery();
 
-	TArray<TObjectPtr<UItemViewModel>> FilteredItems;
-	FilteredItems.Reserve(CachedStoreItems.Num());
+	// A query that only narrows the previous one can be answered from the previous matches alone.
+	const bool bRefine = bRefineNarrowingFilters && bHasLastFilterResult && Query.IsNarrowingOf(LastFilterQuery);
 
-	for (const FStoreItem& ItemData : CachedStoreItems)
+	// Tab counts ignore the category selection, so switching tabs or sort order reuses them.
+	const bool bCountFacets = !bHasFacetCounts || !Query.HasSameTextAs(LastFacetQuery);
+
+	if (!bUseAsyncFiltering || CatalogIndex->Num() < AsyncFilterMinItems)
 	{
-		if (ItemData.bIsOwned)
-		{
-			continue; // Skip owned items in the available items list.
-		}
+		TArray<int32> Matches;
+		FStoreFacetCounts NewFacets;
+		CatalogIndex->Match(Query, bRefine ? &LastFilterMatches : nullptr, Matches, /*bParallel*/ false, bCountFacets ? &NewFacets : nullptr);
+		ApplyFilterResult(Query, MoveTemp(Matches), bCountFacets ? &NewFacets : nullptr);
+		return;
+	}
 
-		// Text filter pass
-		const bool bTextFilterMatch = FilterText.IsEmpty() || ItemData.UIData.DisplayName.ToString().Contains(FilterText);
-		if (!bTextFilterMatch)
-		{
-			continue;
-		}
+	// Snapshot everything the worker needs. Holding a reference to the index makes the model copy it before any change, so a catalog reload can't pull it out from under the task.
+	TSharedPtr<const FStoreCatalogIndex> IndexSnapshot = CatalogIndex;
+	TOptional<TArray<int32>> PreviousMatches;
+	if (bRefine)
+	{
+		PreviousMatches.Emplace(LastFilterMatches);
+	}
 
-		// Category filter pass
-		bool bCategoryMatchFound = SelectedCategories_AvailableItems.IsEmpty();
-		if (!bCategoryMatchFound)
+	UE::Tasks::Launch(UE_SOURCE_LOCATION,
+		[WeakThis = TWeakObjectPtr<UStoreModel>(this), LatestGeneration = FilterGeneration, Generation, IndexSnapshot, Query, PreviousMatches = MoveTemp(PreviousMatches), bCountFacets]()
 		{
-			for (UInteractiveViewModelBase* SelectedVM : SelectedCategories_AvailableItems)
+			TRACE_CPUPROFILER_EVENT_SCOPE_STR("UStoreModel::FilterAvailableStoreItems_Async");
+			if (LatestGeneration->load() != Generation)
 			{
-				const UCategoryViewModel* SelectedCategoryVM = Cast<UCategoryViewModel>(SelectedVM);
-				if (!IsValid(SelectedCategoryVM))
-				{
-					continue;
-				}
+				return; // Superseded before the worker picked it up.
+			}
 
-				// If "All" is selected, the item passes the filter.
-				if (SelectedCategoryVM->IsAll())
-				{
-					bCategoryMatchFound = true;
-					break;
-				}
+			TArray<int32> Matches;
+			TOptional<FStoreFacetCounts> NewFacets;
+			IndexSnapshot->Match(Query, PreviousMatches.GetPtrOrNull(), Matches, /*bParallel*/ true, bCountFacets ? &NewFacets.Emplace() : nullptr);
 
-				// Check if the item's tags match the selected category tag.
-				const FGameplayTag& SelectedCategoryTag = SelectedCategoryVM->GetCategoryTag();
-				if (SelectedCategoryTag.IsValid() && ItemData.Categories.HasTag(SelectedCategoryTag))
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, Generation, Query, Matches = MoveTemp(Matches), NewFacets = MoveTemp(NewFacets)]() mutable
+			{
+				UStoreModel* StrongThis = WeakThis.Get();
+				if (!IsValid(StrongThis) || StrongThis->FilterGeneration->load() != Generation)
 				{
-					bCategoryMatchFound = true;
-					break; // Found a match, no need to check other categories.
+					return; // Stale result from a superseded query, leave the ViewModel alone.
 				}
-			}
-		}
-    
-		// If after checking all categories, no match was found, skip this item.
-		if (!bCategoryMatchFound)
+				StrongThis->ApplyFilterResult(Query, MoveTemp(Matches), NewFacets.GetPtrOrNull());
+			});
+		});
+}
+
+void UStoreModel::StampContentHashes(TArrayView<FStoreItem> Items)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	for (FStoreItem& Item : Items)
+	{
+		// Keep a revision the backend already provided.
+		if (Item.ContentHash == 0)
 		{
-			continue;
+			Item.UpdateContentHash();
 		}
+	}
+}
 
-		UItemViewModel* ItemVM = GetOrCreateItemViewModel(ItemData);
-		FilteredItems.Add(ItemVM);
+void UStoreModel::AssignItemHandles(TArrayView<FStoreItem> Items)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	for (FStoreItem& Item : Items)
+	{
+		Item.Handle = ItemRegistry.FindOrAdd(Item.ItemId);
 	}
+}
 
-	StoreViewModel->SetAvailableItems(FilteredItems);
+TArray<FStoreItemHandle> UStoreModel::FindItemHandles(const TArray<FName>& ItemIds) const
+{
+	TArray<FStoreItemHandle> ItemHandles;
+	ItemHandles.Reserve(ItemIds.Num());
+	for (const FName& ItemId : ItemIds)
+	{
+		ItemHandles.Add(ItemRegistry.Find(ItemId));
+	}
+	return ItemHandles;
 }
 
-void UStoreModel::RefreshStoreData_Implementation()
+void UStoreModel::RebuildCatalogIndex()
 {
-	// Clear any existing error message
-	StoreViewModel->SetErrorMessage(FText::GetEmpty());
-	StoreViewModel->RemoveStoreState(MolecularUITags::Store::State::Error);
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
 
-	// Refresh the store data
-	LazyLoadStoreItems();
-	LazyLoadOwnedItems();
-	LazyLoadStoreCurrency();
+	// Dropping the removed rows shifts the ones after them. The window reads the previous matches on every scroll, so
+	// they follow their rows until the refilter lands.
+	if (CatalogIndex.IsValid() && CatalogIndex->NumRemoved() > 0)
+	{
+		TArray<int32> NewItemIndices;
+		NewItemIndices.Init(INDEX_NONE, CachedStoreItems.Num());
+		int32 WriteIndex = 0;
+		for (int32 ReadIndex = 0; ReadIndex < CachedStoreItems.Num(); ++ReadIndex)
+		{
+			if (ReadIndex < CatalogIndex->Num() && CatalogIndex->Columns.IsRemoved(ReadIndex))
+			{
+				continue;
+			}
+			NewItemIndices[ReadIndex] = WriteIndex;
+			if (WriteIndex != ReadIndex)
+			{
+				CachedStoreItems[WriteIndex] = MoveTemp(CachedStoreItems[ReadIndex]);
+			}
+			++WriteIndex;
+		}
+		CachedStoreItems.SetNum(WriteIndex, EAllowShrinking::No);
+
+		for (int32& ItemIndex : LastFilterMatches)
+		{
+			ItemIndex = NewItemIndices[ItemIndex];
+		}
+		LastFilterMatches.Remove(INDEX_NONE);
+	}
+
+	TSharedRef<FStoreCatalogIndex> NewCatalogIndex = MakeShared<FStoreCatalogIndex>();
+	NewCatalogIndex->Build(CachedStoreItems);
+	CatalogIndex = NewCatalogIndex;
+	StoreViewModel->SetCostHistogram(NewCatalogIndex->CostHistogram);
+
+	// Results still in flight index the old rows.
+	++(*FilterGeneration);
+	bHasLastFilterResult = false;
+	bHasFacetCounts = false;
+	RequestFilterAvailableStoreItems();
+}
+
+void UStoreModel::ApplyStoreChanges(FStoreChangeSet&& Changes)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	// Versions only move forward. An older change set was already covered by a newer one.
+	if (Changes.Version < KnownStoreVersion)
+	{
+		return;
+	}
+	KnownStoreVersion = Changes.Version;
+
+	const TOptional<int32> PlayerCurrency = Changes.PlayerCurrency;
+	const bool bListsChanged = !Changes.StoreUpserts.IsEmpty() || !Changes.StoreRemovals.IsEmpty()
+		|| !Changes.OwnedUpserts.IsEmpty() || !Changes.OwnedRemovals.IsEmpty();
+
+	// Transactions still in flight stay projected on top of the authoritative state until they settle. Their
+	// projections are folded into the change set, so the lists and the index are patched once.
+	int32 PendingCurrencyDelta = 0;
+	for (const FPendingTransaction& Pending : PendingTransactions)
+	{
+		if (bListsChanged)
+		{
+			MergeChangeSets(Changes, Pending.Projection);
+		}
+		PendingCurrencyDelta += Pending.CurrencyDelta;
+	}
+	ApplyItemListChanges(MoveTemp(Changes));
+
+	if (PlayerCurrency.IsSet())
+	{
+		StoreViewModel->SetPlayerCurrency(PlayerCurrency.GetValue() + PendingCurrencyDelta);
+	}
+}
+
+void UStoreModel::ApplyItemListChanges(FStoreChangeSet&& Changes)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	StampContentHashes(Changes.StoreUpserts);
+	AssignItemHandles(Changes.StoreUpserts);
+	StampContentHashes(Changes.OwnedUpserts);
+	AssignItemHandles(Changes.OwnedUpserts);
+	const TArray<FStoreItemHandle> StoreRemovals = FindItemHandles(Changes.StoreRemovals);
+	const TArray<FStoreItemHandle> OwnedRemovals = FindItemHandles(Changes.OwnedRemovals);
+
+	if (!Changes.StoreUpserts.IsEmpty() || !StoreRemovals.IsEmpty())
+	{
+		SyncCategoryTabs(Changes.StoreUpserts);
+		PatchStoreItems(MoveTemp(Changes.StoreUpserts), StoreRemovals);
+	}
+
+	if (!Changes.OwnedUpserts.IsEmpty() || !OwnedRemovals.IsEmpty())
+	{
+		ApplyItemChanges(CachedOwnedItems, MoveTemp(Changes.OwnedUpserts), OwnedRemovals);
+		PublishOwnedItems();
+	}
+
+	ReleaseItemHandlesIfUnused(StoreRemovals);
+	ReleaseItemHandlesIfUnused(OwnedRemovals);
+	TrimItemViewModelCache();
+}
+
+void UStoreModel::MergeChangeSets(FStoreChangeSet& Into, const FStoreChangeSet& Later)
+{
+	// A later change to an item replaces any earlier one, whether an upsert or a removal.
+	auto MergeList = [](TArray<FStoreItem>& Upserts, TArray<FName>& Removals, const TArray<FStoreItem>& LaterUpserts, const TArray<FName>& LaterRemovals)
+	{
+		if (LaterUpserts.IsEmpty() && LaterRemovals.IsEmpty())
+		{
+			return;
+		}
+		TSet<FName> LaterItemIds(LaterRemovals);
+		for (const FStoreItem& Item : LaterUpserts)
+		{
+			LaterItemIds.Add(Item.ItemId);
+		}
+		Upserts.RemoveAll([&LaterItemIds](const FStoreItem& Item) { return LaterItemIds.Contains(Item.ItemId); });
+		Removals.RemoveAll([&LaterItemIds](const FName& ItemId) { return LaterItemIds.Contains(ItemId); });
+		Upserts.Append(LaterUpserts);
+		Removals.Append(LaterRemovals);
+	};
+	MergeList(Into.StoreUpserts, Into.StoreRemovals, Later.StoreUpserts, Later.StoreRemovals);
+	MergeList(Into.OwnedUpserts, Into.OwnedRemovals, Later.OwnedUpserts, Later.OwnedRemovals);
+}
+
+void UStoreModel::PublishOwnedItems()
+{
+	OwnedItemsSnapshot.Reset();
+	RefreshOwnedItemsWindow(/*bForce*/ true);
+	if (bPublishFullItemLists)
+	{
+		StoreViewModel->SetOwnedItems(GetOrCreateItemViewModels(CachedOwnedItems));
+	}
+}
+
+bool UStoreModel::CanStartTransaction() const
+{
+	// A change sync running in the background doesn't count, its change set is applied with the pending transactions
+	// projected over it. Neither do trades still in flight, each is projected on top of the ones before it and undone on its own.
+	FGameplayTagContainer TradeableStates;
+	TradeableStates.AddTag(MolecularUITags::Store::State::Ready);
+	TradeableStates.AddTag(MolecularUITags::Store::State::Loading::Changes);
+	TradeableStates.AddTag(MolecularUITags::Store::State::Purchasing);
+	TradeableStates.AddTag(MolecularUITags::Store::State::Selling);
+	const FGameplayTagContainer& StoreStates = StoreViewModel->GetStoreStates();
+	return !StoreStates.IsEmpty() && TradeableStates.HasAllExact(StoreStates);
+}
+
+uint32 UStoreModel::ProjectTransaction(const FTransactionRequest& Request, const bool bPurchase)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	FPendingTransaction Pending;
+	Pending.bPurchase = bPurchase;
+	TArray<FStoreItem> MovedItems;
+	for (const FName& ItemId : Request.ItemIds)
+	{
+		const FStoreItemHandle Handle = ItemRegistry.Find(ItemId);
+		const FStoreItem* Item = nullptr;
+		if (bPurchase)
+		{
+			const int32 ItemIndex = CatalogIndex.IsValid() ? CatalogIndex->FindItemIndex(Handle) : INDEX_NONE;
+			Item = ItemIndex != INDEX_NONE ? &CachedStoreItems[ItemIndex] : nullptr;
+		}
+		else
+		{
+			const int32 OwnedIndex = CachedOwnedItems.IndexOfByPredicate([&Handle](const FStoreItem& OwnedItem) { return OwnedItem.Handle == Handle; });
+			Item = OwnedIndex != INDEX_NONE ? &CachedOwnedItems[OwnedIndex] : nullptr;
+			Pending.OriginalOwnedIndices.Add(OwnedIndex);
+		}
+		if (Item == nullptr || !Handle.IsValid())
+		{
+			return 0; // Not something the player can trade from here. The provider will say so.
+		}
+
+		Pending.OriginalItems.Add(*Item);
+		FStoreItem& MovedItem = MovedItems.Add_GetRef(*Item);
+		MovedItem.bIsOwned = bPurchase;
+		MovedItem.ContentHash = 0; // Restamped, since the owned state is part of the content.
+		Pending.CurrencyDelta += bPurchase ? -Item->Cost : StoreDataProviderInterface->GetSellRefund(*Item);
+	}
+	if (MovedItems.IsEmpty() || StoreViewModel->GetPlayerCurrency() + Pending.CurrencyDelta < 0)
+	{
+		return 0;
+	}
+
+	if (bPurchase)
+	{
+		Pending.Projection.StoreRemovals = Request.ItemIds;
+		Pending.Projection.OwnedUpserts = MoveTemp(MovedItems);
+	}
+	else
+	{
+		Pending.Projection.OwnedRemovals = Request.ItemIds;
+		Pending.Projection.StoreUpserts = MoveTemp(MovedItems);
+	}
+
+	FStoreChangeSet Projection = Pending.Projection;
+	ApplyItemListChanges(MoveTemp(Projection));
+	StoreViewModel->SetPlayerCurrency(StoreViewModel->GetPlayerCurrency() + Pending.CurrencyDelta);
+
+	Pending.Id = ++TransactionSerial;
+	return PendingTransactions.Add_GetRef(MoveTemp(Pending)).Id;
+}
+
+void UStoreModel::RollbackTransaction(const uint32 TransactionId)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	const int32 PendingIndex = PendingTransactions.IndexOfByPredicate([TransactionId](const FPendingTransaction& Pending) { return Pending.Id == TransactionId; });
+	if (TransactionId == 0 || PendingIndex == INDEX_NONE)
+	{
+		return;
+	}
+	FPendingTransaction Pending = MoveTemp(PendingTransactions[PendingIndex]);
+	PendingTransactions.RemoveAt(PendingIndex);
+
+	// The inverse move: the items go back to the list they came from, as they were and where they were. Bought items
+	// take back the store rows they left, which the index keeps until it is rebuilt.
+	FStoreChangeSet Rollback;
+	if (Pending.bPurchase)
+	{
+		Rollback.OwnedRemovals = MoveTemp(Pending.Projection.StoreRemovals);
+		Rollback.StoreUpserts = MoveTemp(Pending.OriginalItems);
+	}
+	else
+	{
+		// Sold items are put back in the owned list first, so they still hold their handles when the store lets go.
+		// In order of position, so each lands before the ones that followed it.
+		TArray<int32> RestoreOrder;
+		RestoreOrder.Reserve(Pending.OriginalItems.Num());
+		for (int32 Index = 0; Index < Pending.OriginalItems.Num(); ++Index)
+		{
+			RestoreOrder.Add(Index);
+		}
+		Algo::SortBy(RestoreOrder, [&Pending](const int32 Index) { return Pending.OriginalOwnedIndices[Index]; });
+		for (const int32 Index : RestoreOrder)
+		{
+			FStoreItem& Item = Pending.OriginalItems[Index];
+			const int32 OwnedIndex = CachedOwnedItems.IndexOfByPredicate([&Item](const FStoreItem& OwnedItem) { return OwnedItem.Handle == Item.Handle; });
+			if (OwnedIndex != INDEX_NONE)
+			{
+				CachedOwnedItems[OwnedIndex] = MoveTemp(Item); // A change set listed it as owned in the meantime.
+			}
+			else
+			{
+				CachedOwnedItems.Insert(MoveTemp(Item), FMath::Min(Pending.OriginalOwnedIndices[Index], CachedOwnedItems.Num()));
+			}
+		}
+		PublishOwnedItems();
+		Rollback.StoreRemovals = MoveTemp(Pending.Projection.OwnedRemovals);
+	}
+	ApplyItemListChanges(MoveTemp(Rollback));
+	StoreViewModel->SetPlayerCurrency(StoreViewModel->GetPlayerCurrency() - Pending.CurrencyDelta);
+}
+
+void UStoreModel::ConfirmTransaction(const uint32 TransactionId)
+{
+	PendingTransactions.RemoveAll([TransactionId](const FPendingTransaction& Pending) { return Pending.Id == TransactionId; });
+
+	// The projection may differ from what the provider did, e.g. in the refund. The change set settles it.
+	SyncStoreChanges();
+}
+
+void UStoreModel::ApplyItemChanges(TArray<FStoreItem>& Items, TArray<FStoreItem>&& Upserts, TConstArrayView<FStoreItemHandle> Removals) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	// Per handle: the position of its upsert, or one of these.
+	constexpr int32 Unchanged = INDEX_NONE;
+	constexpr int32 Removed = -2;
+	constexpr int32 Applied = -3;
+	TArray<int32> ChangeByHandle;
+	ChangeByHandle.Init(Unchanged, ItemRegistry.GetMaxIndex());
+	for (const FStoreItemHandle& Handle : Removals)
+	{
+		if (Handle.IsValid())
+		{
+			ChangeByHandle[Handle.Index] = Removed;
+		}
+	}
+	for (int32 UpsertIndex = 0; UpsertIndex < Upserts.Num(); ++UpsertIndex)
+	{
+		if (Upserts[UpsertIndex].Handle.IsValid())
+		{
+			ChangeByHandle[Upserts[UpsertIndex].Handle.Index] = UpsertIndex;
+		}
+	}
+
+	int32 WriteIndex = 0;
+	for (int32 ReadIndex = 0; ReadIndex < Items.Num(); ++ReadIndex)
+	{
+		const FStoreItemHandle Handle = Items[ReadIndex].Handle;
+		const int32 Change = Handle.IsValid() ? ChangeByHandle[Handle.Index] : Unchanged;
+		if (Change == Removed)
+		{
+			continue;
+		}
+		if (Change >= 0)
+		{
+			Items[ReadIndex] = MoveTemp(Upserts[Change]);
+			ChangeByHandle[Handle.Index] = Applied;
+		}
+		if (WriteIndex != ReadIndex)
+		{
+			Items[WriteIndex] = MoveTemp(Items[ReadIndex]);
+		}
+		++WriteIndex;
+	}
+	Items.SetNum(WriteIndex, EAllowShrinking::No);
+
+	// Upserts the list didn't have yet are new entries, appended in the order they came.
+	for (int32 UpsertIndex = 0; UpsertIndex < Upserts.Num(); ++UpsertIndex)
+	{
+		const FStoreItemHandle Handle = Upserts[UpsertIndex].Handle;
+		if (Handle.IsValid() && ChangeByHandle[Handle.Index] == UpsertIndex)
+		{
+			Items.Add(MoveTemp(Upserts[UpsertIndex]));
+		}
+	}
+}
+
+void UStoreModel::PatchStoreItems(TArray<FStoreItem>&& Upserts, TConstArrayView<FStoreItemHandle> Removals)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	// Pages an async pass kept from being indexed are caught up first, so every row has a position to patch. The
+	// facet counts never saw those rows, so they are recounted by the next pass instead of patched.
+	const TSharedRef<FStoreCatalogIndex> Index = MakeCatalogIndexWritable();
+	if (Index->Num() < CachedStoreItems.Num())
+	{
+		Index->Append(CachedStoreItems);
+		bHasFacetCounts = false;
+	}
+
+	TArray<int32> RemovedItems;
+	RemovedItems.Reserve(Removals.Num());
+	for (const FStoreItemHandle& Handle : Removals)
+	{
+		const int32 ItemIndex = Index->FindItemIndex(Handle);
+		if (ItemIndex != INDEX_NONE)
+		{
+			RemovedItems.Add(ItemIndex);
+		}
+	}
+
+	// An upsert replaces its item's row, or takes back the row it held before it was removed. Other upserts are new
+	// entries, appended in the order they came.
+	TArray<int32> ChangedItems;
+	ChangedItems.Reserve(Upserts.Num());
+	TMap<int32, int32> NewItemIndices; // By handle index, in case a change set lists a new item twice.
+	for (FStoreItem& Upsert : Upserts)
+	{
+		const int32 ItemIndex = Index->FindItemSlot(Upsert.Handle);
+		if (ItemIndex != INDEX_NONE)
+		{
+			CachedStoreItems[ItemIndex] = MoveTemp(Upsert);
+			ChangedItems.Add(ItemIndex);
+		}
+		else if (const int32* NewItemIndex = NewItemIndices.Find(Upsert.Handle.Index))
+		{
+			CachedStoreItems[*NewItemIndex] = MoveTemp(Upsert);
+		}
+		else
+		{
+			const int32 HandleIndex = Upsert.Handle.Index;
+			NewItemIndices.Add(HandleIndex, CachedStoreItems.Add(MoveTemp(Upsert)));
+		}
+	}
+
+	// The touched rows leave the facet counts before the patch and come back after it, as whatever they became.
+	// Buying or selling an item, or a change set, then costs a few tag counts rather than a sweep of the catalog.
+	TArray<int32> TouchedItems = RemovedItems;
+	TouchedItems.Append(ChangedItems);
+	Algo::Sort(TouchedItems);
+	TouchedItems.SetNum(Algo::Unique(TouchedItems));
+	auto AdjustFacets = [this, &Index](const int32 ItemIndex, const int32 Delta)
+	{
+		if (Index->Columns.IsAvailable(ItemIndex) && Index->MatchesText(LastFacetQuery, ItemIndex))
+		{
+			Index->AdjustFacets(ItemIndex, Delta, FacetCounts);
+		}
+	};
+	if (bHasFacetCounts)
+	{
+		for (const int32 ItemIndex : TouchedItems)
+		{
+			AdjustFacets(ItemIndex, -1);
+		}
+	}
+
+	const int32 FirstNewItem = Index->Num();
+	Index->ApplyChanges(CachedStoreItems, ChangedItems, RemovedItems);
+
+	if (bHasFacetCounts)
+	{
+		FacetCounts.CountsByTag.SetNumZeroed(Index->CategoryIndex.NumTags()); // New tags start with no items.
+		for (const int32 ItemIndex : TouchedItems)
+		{
+			AdjustFacets(ItemIndex, 1);
+		}
+		for (int32 ItemIndex = FirstNewItem; ItemIndex < Index->Num(); ++ItemIndex)
+		{
+			AdjustFacets(ItemIndex, 1);
+		}
+	}
+
+	// Every pass skips the tombstones, but past a point compacting them away costs less than skipping them.
+	if (Index->NumRemoved() > FMath::Max(64, Index->Num() / 4))
+	{
+		RebuildCatalogIndex();
+		return;
+	}
+	if (Index->HasOrderings())
+	{
+		StoreViewModel->SetCostHistogram(Index->CostHistogram);
+	}
+
+	// The previous matches and any result in flight may list items that were just removed, bought or changed. The
+	// unavailable ones are dropped now, since the window reads the matches on every scroll, and the rest is refiltered.
+	++(*FilterGeneration);
+	LastFilterMatches.RemoveAll([&Index](const int32 ItemIndex) { return !Index->Columns.IsAvailable(ItemIndex); });
+	bHasLastFilterResult = false;
+	if (bHasFacetCounts)
+	{
+		PublishFacetCounts();
+	}
+	RequestFilterAvailableStoreItems();
+}
+
+void UStoreModel::ReleaseItemHandle(const FStoreItemHandle Handle)
+{
+	if (!ItemRegistry.IsValid(Handle))
+	{
+		return;
+	}
+	if (ItemViewModelCache.IsValidIndex(Handle.Index) && ItemViewModelCache[Handle.Index] != nullptr)
+	{
+		// Published lists may still point at it until the next filter pass, so it is left to GC rather than pooled.
+		// Its interactions no longer reach the model, since the handle they would resolve to may be reused.
+		if (UItemViewModel* ItemVM = ItemViewModelCache[Handle.Index]; IsValid(ItemVM))
+		{
+			UE_MVVM_UNBIND_FIELD(ItemVM, Interaction);
+		}
+		ItemViewModelCache[Handle.Index] = nullptr;
+		ItemViewModelLastUse[Handle.Index] = 0;
+		--NumCachedItemViewModels;
+	}
+	ItemRegistry.Release(Handle);
+}
+
+void UStoreModel::ReleaseItemHandlesIfUnused(TConstArrayView<FStoreItemHandle> Handles)
+{
+	if (Handles.IsEmpty())
+	{
+		return;
+	}
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	// Handles are dense, so a bit per handle is the whole set of items still held somewhere.
+	TBitArray<> HeldHandles(false, ItemRegistry.GetMaxIndex());
+	auto MarkHeld = [this, &HeldHandles](TConstArrayView<FStoreItem> Items)
+	{
+		for (const FStoreItem& Item : Items)
+		{
+			if (ItemRegistry.IsValid(Item.Handle))
+			{
+				HeldHandles[Item.Handle.Index] = true;
+			}
+		}
+	};
+	MarkHeld(CachedOwnedItems);
+	MarkHeld(ReloadedStoreItems);
+
+	// Removed store rows stay in place until the index is rebuilt, but no longer hold their handles.
+	for (int32 ItemIndex = 0; ItemIndex < CachedStoreItems.Num(); ++ItemIndex)
+	{
+		const FStoreItemHandle Handle = CachedStoreItems[ItemIndex].Handle;
+		const bool bRemoved = CatalogIndex.IsValid() && ItemIndex < CatalogIndex->Num() && CatalogIndex->Columns.IsRemoved(ItemIndex);
+		if (!bRemoved && ItemRegistry.IsValid(Handle))
+		{
+			HeldHandles[Handle.Index] = true;
+		}
+	}
+	for (const FPendingTransaction& Pending : PendingTransactions)
+	{
+		MarkHeld(Pending.OriginalItems); // A rollback puts these back under their handles.
+	}
+
+	// Items that left every list don't come back under the same handle.
+	for (const FStoreItemHandle& Handle : Handles)
+	{
+		if (ItemRegistry.IsValid(Handle) && !HeldHandles[Handle.Index])
+		{
+			ReleaseItemHandle(Handle);
+		}
+	}
+}
+
+TSharedRef<FStoreCatalogIndex> UStoreModel::MakeCatalogIndexWritable()
+{
+	if (!CatalogIndex.IsValid())
+	{
+		CatalogIndex = MakeShared<FStoreCatalogIndex>();
+	}
+	else if (!CatalogIndex.IsUnique())
+	{
+		// An async pass still reads it. The pass keeps the old index, and the model goes on with a copy.
+		CatalogIndex = MakeShared<FStoreCatalogIndex>(*CatalogIndex);
+	}
+
+	// No async pass holds a reference now, so nothing can observe the index changing.
+	return ConstCastSharedRef<FStoreCatalogIndex>(CatalogIndex.ToSharedRef());
+}
+
+void UStoreModel::AppendToCatalogIndex(const bool bBuildOrderings)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	if (CatalogIndex.IsValid() && !CatalogIndex.IsUnique() && !bBuildOrderings)
+	{
+		// Copying the whole index for every page would make a paged load quadratic. The new entries wait for the next
+		// page or filter pass that finds the index unshared, or for the last page.
+		return;
+	}
+
+	const TSharedRef<FStoreCatalogIndex> NewCatalogIndex = MakeCatalogIndexWritable();
+	NewCatalogIndex->Append(CachedStoreItems);
+	if (bBuildOrderings)
+	{
+		NewCatalogIndex->BuildOrderings();
+		StoreViewModel->SetCostHistogram(NewCatalogIndex->CostHistogram);
+	}
+
+	// Previous matches are still valid indices, but they can't include the new items.
+	bHasLastFilterResult = false;
+	bHasFacetCounts = false;
+}
+
+void UStoreModel::HandleCultureChanged()
+{
+	if (!CatalogIndex.IsValid())
+	{
+		return; // Nothing loaded yet, the first load folds with the new culture.
+	}
+	RebuildCatalogIndex();
+}
+
+void UStoreModel::ApplyFilterResult(const FStoreFilterQuery& Query, TArray<int32>&& Matches, FStoreFacetCounts* NewFacets)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	LastFilterQuery = Query;
+	LastFilterMatches = MoveTemp(Matches);
+	bHasLastFilterResult = true;
+
+	if (NewFacets != nullptr)
+	{
+		FacetCounts = MoveTemp(*NewFacets);
+		LastFacetQuery = Query;
+		bHasFacetCounts = true;
+		PublishFacetCounts();
+	}
+
+	RefreshAvailableItemsWindow(/*bForce*/ true);
+
+	if (bPublishFullItemLists)
+	{
+		TArray<TObjectPtr<UItemViewModel>> FilteredItems;
+		FilteredItems.Reserve(LastFilterMatches.Num());
+		for (const int32 ItemIndex : LastFilterMatches)
+		{
+			UItemViewModel* ItemVM = GetOrCreateItemViewModel(CachedStoreItems[ItemIndex]);
+			FilteredItems.Add(ItemVM);
+		}
+		StoreViewModel->SetAvailableItems(FilteredItems);
+	}
+
+	TrimItemViewModelCache();
+}
+
+void UStoreModel::PublishFacetCounts()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	for (UCategoryViewModel* CategoryVM : StoreViewModel->GetCategoryTabs_AvailableItems())
+	{
+		if (!IsValid(CategoryVM))
+		{
+			continue;
+		}
+		const int32 TagId = CatalogIndex.IsValid() ? CatalogIndex->CategoryIndex.FindTagId(CategoryVM->GetCategoryTag()) : INDEX_NONE;
+		CategoryVM->SetMatchCount(CategoryVM->IsAll() ? FacetCounts.Total : FacetCounts.GetCount(TagId));
+	}
+}
+
+void UStoreModel::RefreshItemWindow(UWindowedCollectionViewModel* WindowVM, const int32 TotalCount, TFunctionRef<UItemViewModel*(int32)> GetItem, const bool bForce)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+	if (!IsValid(WindowVM))
+	{
+		return;
+	}
+
+	WindowVM->SetTotalCount(TotalCount);
+
+	// Scrolling within the prefetched margin needs no new window.
+	if (!bForce && WindowVM->IsVisibleRangeLoaded())
+	{
+		return;
+	}
+
+	int32 WindowStart = 0;
+	int32 WindowEnd = 0;
+	WindowVM->GetRequestedWindow(WindowStart, WindowEnd);
+
+	TArray<TObjectPtr<UMVVMViewModelBase>> WindowItems;
+	WindowItems.Reserve(WindowEnd - WindowStart);
+	for (int32 Index = WindowStart; Index < WindowEnd; ++Index)
+	{
+		WindowItems.Add(GetItem(Index));
+	}
+	WindowVM->SetWindow(WindowStart, WindowItems);
+}
+
+void UStoreModel::RefreshAvailableItemsWindow(const bool bForce)
+{
+	RefreshItemWindow(AvailableItemsWindow, LastFilterMatches.Num(), [this](const int32 Index)
+	{
+		return GetOrCreateItemViewModel(CachedStoreItems[LastFilterMatches[Index]]);
+	}, bForce);
+}
+
+void UStoreModel::RefreshOwnedItemsWindow(const bool bForce)
+{
+	RefreshItemWindow(OwnedItemsWindow, CachedOwnedItems.Num(), [this](const int32 Index)
+	{
+		return GetOrCreateItemViewModel(CachedOwnedItems[Index]);
+	}, bForce);
+}
+
+void UStoreModel::RequestRefreshStoreData()
+{
+	UWorld* World = GetWorld();
+	if (!IsValid(World))
+	{
+		RefreshStoreData();
+		return;
+	}
+
+	FTimerManager& TimerManager = World->GetTimerManager();
+	if (TimerManager.IsTimerActive(TrailingRefreshHandle))
+	{
+		return; // The pending refresh will pick up whatever changed by then.
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	if (RefreshBucket.TryConsume(Now))
+	{
+		RefreshStoreData();
+		return;
+	}
+
+	const double WaitSeconds = RefreshBucket.GetSecondsUntilNextToken(Now);
+	if (WaitSeconds == MAX_dbl)
+	{
+		UE_LOG(LogMolecularUI, Verbose, TEXT("[%hs] Refresh burst spent and RefreshTokensPerSecond is 0. Dropping the request."), __FUNCTION__);
+		return;
+	}
+
+	UE_LOG(LogMolecularUI, Verbose, TEXT("[%hs] Refreshing too often. Deferring by %.2f s."), __FUNCTION__, WaitSeconds);
+	TimerManager.SetTimer(TrailingRefreshHandle,
+		FTimerDelegate::CreateWeakLambda(this, [this]()
+		{
+			RefreshBucket.TryConsume(FPlatformTime::Seconds());
+			RefreshStoreData();
+		}),
+		static_cast<float>(WaitSeconds), false);
+}
+
+void UStoreModel::RequestFilterAvailableStoreItems(const bool bDebounce)
+{
+	UWorld* World = GetWorld();
+	if (!IsValid(World))
+	{
+		FilterAvailableStoreItems();
+		return;
+	}
+
+	const float DebounceSeconds = MolecularUI::CVars::Store::FilterDebounceSeconds;
+	if (bDebounce && DebounceSeconds > 0.0f)
+	{
+		// Restarting the timer on every keystroke runs a single pass once the burst pauses.
+		World->GetTimerManager().SetTimer(FilterDebounceHandle,
+			FTimerDelegate::CreateWeakLambda(this, [this]() { RequestFilterAvailableStoreItems(); }),
+			DebounceSeconds, false);
+		return;
+	}
+
+	// This request covers any debounced one that hasn't fired yet.
+	World->GetTimerManager().ClearTimer(FilterDebounceHandle);
+
+	if (PendingFilterHandle.IsValid())
+	{
+		return; // A pass is already scheduled for the end of this tick.
+	}
+
+	PendingFilterHandle = FWorldDelegates::OnWorldPostActorTick.AddWeakLambda(this,
+		[this, WeakWorld = TWeakObjectPtr<UWorld>(World)](UWorld* TickedWorld, ELevelTick, float)
+		{
+			if (TickedWorld != WeakWorld.Get())
+			{
+				return;
+			}
+			FWorldDelegates::OnWorldPostActorTick.Remove(PendingFilterHandle);
+			PendingFilterHandle.Reset();
+			FilterAvailableStoreItems();
+		});
+}
+
+FStoreFilterQuery UStoreModel::MakeFilterQuery() const
+{
+	FStoreFilterQuery Query;
+	Query.FoldedText = FStoreTextIndex::FoldText(StoreViewModel->GetFilterText());
+	Query.MinCost = StoreViewModel->GetMinCostFilter();
+	Query.MaxCost = StoreViewModel->GetMaxCostFilter();
+	Query.SearchMode = StoreViewModel->GetSearchMode();
+	Query.MaxFuzzyResults = MaxFuzzyResults;
+	Query.SortMode = StoreViewModel->GetSortMode();
+
+	const TArray<UInteractiveViewModelBase*>& SelectedCategories_AvailableItems = SelectionViewModel_Store_Tabs->GetSelectedViewModels();
+	Query.bAnyCategory = SelectedCategories_AvailableItems.IsEmpty();
+	for (UInteractiveViewModelBase* SelectedVM : SelectedCategories_AvailableItems)
+	{
+		const UCategoryViewModel* SelectedCategoryVM = Cast<UCategoryViewModel>(SelectedVM);
+		if (!IsValid(SelectedCategoryVM))
+		{
+			continue;
+		}
+
+		// If "All" is selected, every item passes the category filter.
+		if (SelectedCategoryVM->IsAll())
+		{
+			Query.bAnyCategory = true;
+			Query.CategoryTags.Reset();
+			break;
+		}
+
+		const FGameplayTag& SelectedCategoryTag = SelectedCategoryVM->GetCategoryTag();
+		if (SelectedCategoryTag.IsValid())
+		{
+			Query.CategoryTags.AddTag(SelectedCategoryTag);
+		}
+	}
+	return Query;
+}
+
+void UStoreModel::RefreshStoreData_Implementation()
+{
+	// Clear any existing error message
+	StoreViewModel->SetErrorMessage(FText::GetEmpty());
+	StoreViewModel->RemoveStoreState(MolecularUITags::Store::State::Error);
+
+	// Refresh the store data
+	LazyLoadStoreItems();
+	LazyLoadOwnedItems();
+	LazyLoadStoreCurrency();
 
 	SelectionViewModel_Store->ClearPreview();
 	SelectionViewModel_Store->ClearSelection();
@@ -635,51 +1855,311 @@ void UStoreModel::RefreshStoreData_Implementation()
 
 UItemViewModel* UStoreModel::GetOrCreateItemViewModel(const FStoreItem& ItemData)
 {
+	// Ingested items carry their handle. Anything else pays for one ItemId lookup.
+	const FStoreItemHandle Handle = ItemRegistry.IsValid(ItemData.Handle) ? ItemData.Handle : ItemRegistry.FindOrAdd(ItemData.ItemId);
+	if (!ensure(Handle.IsValid()))
+	{
+		return nullptr;
+	}
+	if (Handle.Index >= ItemViewModelCache.Num())
+	{
+		ItemViewModelCache.SetNum(ItemRegistry.GetMaxIndex());
+		ItemViewModelLastUse.SetNumZeroed(ItemRegistry.GetMaxIndex());
+	}
+	ItemViewModelLastUse[Handle.Index] = ++ItemViewModelUseCounter;
+
 	// Check if the ViewModel already exists in the cache and is valid.
-	if (TObjectPtr<UItemViewModel>* FoundViewModel = ItemViewModelCache.Find(ItemData.ItemId))
+	TObjectPtr<UItemViewModel>& CachedViewModel = ItemViewModelCache[Handle.Index];
+	if (IsValid(CachedViewModel))
 	{
-		if (IsValid(*FoundViewModel))
-		{
-			// It exists, update its data just in case it changed and return it.
-			(*FoundViewModel)->SetItemData(ItemData);
-			return *FoundViewModel;
-		}
+		++ItemViewModelCacheStats.Hits;
+		// It exists, update its data just in case it changed and return it.
+		CachedViewModel->SetItemData(ItemData);
+		return CachedViewModel;
 	}
+	++ItemViewModelCacheStats.Misses;
 
-	// If not found or was invalid (e.g. garbage collected), create a new one.
-	UItemViewModel* NewItemVM = NewObject<UItemViewModel>(StoreViewModel);
+	// If not found or was invalid (e.g. garbage collected), reuse an evicted one or create a new one.
+	UItemViewModel* NewItemVM = nullptr;
+	if (!ItemViewModelPool.IsEmpty())
+	{
+		NewItemVM = ItemViewModelPool.Pop(EAllowShrinking::No);
+		++ItemViewModelCacheStats.PoolReuses;
+	}
+	else
+	{
+		NewItemVM = NewObject<UItemViewModel>(StoreViewModel);
+	}
 	NewItemVM->SetItemData(ItemData);
 
 	// Bind the interaction FieldNotify to the ViewModel's OnItemInteractionChanged handler.
 	UE_MVVM_BIND_FIELD(UItemViewModel, NewItemVM, Interaction, OnItemInteractionChanged);
 
-	// Add the new ViewModel to the cache for future reuse.
-	ItemViewModelCache.Add(ItemData.ItemId, NewItemVM);
+	// Add the new ViewModel to the cache for future reuse. A slot holding a garbage collected one was already counted.
+	if (CachedViewModel == nullptr)
+	{
+		++NumCachedItemViewModels;
+	}
+	CachedViewModel = NewItemVM;
 
-	// Set the category view models if needed.
-	// This generates the category ViewModels that are associated with this item.
+	// Point the item at the shared category ViewModels for its tags.
 	// They can be used to represent category tabs to filter items in the store or to show item details, or any other UI element that needs to display categories.
 	TArray<TObjectPtr<UCategoryViewModel>> CategoryVMs;
+	CategoryVMs.Reserve(ItemData.Categories.Num());
 	for (const FGameplayTag& CategoryTag : ItemData.Categories)
 	{
-		UCategoryViewModel* CategoryVM = NewObject<UCategoryViewModel>(NewItemVM);
-		CategoryVM->SetCategoryTag(CategoryTag);
+		CategoryVMs.Add(GetOrCreateCategoryViewModel(CategoryTag));
+	}
+	NewItemVM->SetCategoryViewModels(CategoryVMs);
+
+	return NewItemVM;
+}
+
+TArray<TObjectPtr<UItemViewModel>> UStoreModel::GetOrCreateItemViewModels(TConstArrayView<FStoreItem> Items)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	TArray<TObjectPtr<UItemViewModel>> ItemVMs;
+	ItemVMs.Reserve(Items.Num());
+
+	// Handles are dense, so a bit per handle is the whole seen set.
+	TBitArray<> SeenHandles(false, ItemRegistry.GetMaxIndex());
+	for (const FStoreItem& ItemData : Items)
+	{
+		const FStoreItemHandle Handle = ItemRegistry.IsValid(ItemData.Handle) ? ItemData.Handle : ItemRegistry.FindOrAdd(ItemData.ItemId);
+		if (!Handle.IsValid())
+		{
+			continue;
+		}
+		if (Handle.Index >= SeenHandles.Num())
+		{
+			SeenHandles.Add(false, Handle.Index + 1 - SeenHandles.Num());
+		}
+		if (!SeenHandles[Handle.Index])
+		{
+			SeenHandles[Handle.Index] = true;
+			ItemVMs.Add(GetOrCreateItemViewModel(ItemData));
+		}
+	}
+	return ItemVMs;
+}
+
+UCategoryViewModel* UStoreModel::GetOrCreateCategoryViewModel(const FGameplayTag& CategoryTag)
+{
+	if (const TObjectPtr<UCategoryViewModel>* FoundViewModel = CategoryViewModelRegistry.Find(CategoryTag))
+	{
+		if (IsValid(*FoundViewModel))
+		{
+			return *FoundViewModel;
+		}
+	}
 
-		// TODO: Look up UI data mapped to the category tag in project settings
+	UCategoryViewModel* CategoryVM = NewObject<UCategoryViewModel>(StoreViewModel);
+	CategoryVM->SetCategoryTag(CategoryTag);
+
+	if (const FStandardUIData* ResolvedUIData = ResolvedCategoryUIData.Find(CategoryTag))
+	{
+		CategoryVM->SetUIData(*ResolvedUIData);
+	}
+	else
+	{
+		// Not in the project settings, fall back to the tag name. Only formatted once per tag since the ViewModel is interned.
 		FStandardUIData CategoryUIData;
-		CategoryUIData.DisplayName = FText::FromString(CategoryTag.GetTagName().ToString());
+		CategoryUIData.DisplayName = FText::FromName(CategoryTag.GetTagName());
 		CategoryUIData.Description = FText::FromString(FString::Printf(TEXT("Category: %s"), *CategoryTag.GetTagName().ToString()));
 		CategoryUIData.Icon = FSlateBrush();
 		CategoryVM->SetUIData(CategoryUIData);
-	
-		UE_MVVM_BIND_FIELD(UCategoryViewModel, CategoryVM, Interaction, OnItemCategoryInteractionChanged);
-		CategoryVMs.Add(CategoryVM);
-		if (bAutoGenerateCategoriesFromItems)
+	}
+
+	// Bound once here, for every tab and item that shows this category.
+	UE_MVVM_BIND_FIELD(UCategoryViewModel, CategoryVM, Interaction, OnItemCategoryInteractionChanged);
+	CategoryViewModelRegistry.Add(CategoryTag, CategoryVM);
+	return CategoryVM;
+}
+
+void UStoreModel::SyncCategoryTabs(TConstArrayView<FStoreItem> Items)
+{
+	if (!bAutoGenerateCategoriesFromItems)
+	{
+		return;
+	}
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	// Distinct tags in order of first appearance, so tabs keep following the catalog order.
+	TSet<FGameplayTag> CategoryTags;
+	for (const FStoreItem& Item : Items)
+	{
+		for (const FGameplayTag& CategoryTag : Item.Categories)
 		{
-			StoreViewModel->AddCategory_AvailableItems(CategoryVM);
+			CategoryTags.Add(CategoryTag);
 		}
 	}
-	NewItemVM->SetCategoryViewModels(CategoryVMs);
 
-	return NewItemVM;
+	TArray<UCategoryViewModel*> CategoryVMs;
+	CategoryVMs.Reserve(CategoryTags.Num());
+	for (const FGameplayTag& CategoryTag : CategoryTags)
+	{
+		CategoryVMs.Add(GetOrCreateCategoryViewModel(CategoryTag));
+	}
+	StoreViewModel->AddCategories_AvailableItems(CategoryVMs);
+}
+
+void UStoreModel::ResolveCategoryUIData()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	const TMap<FGameplayTag, FCategoryUIDefinition>& Definitions = UMolecularUISettings::GetCategoryUIDefinitions();
+	ResolvedCategoryUIData.Empty(Definitions.Num());
+
+	TArray<FSoftObjectPath> PendingIcons;
+	TArray<FGameplayTag> PendingTags;
+	auto RequestPendingIcons = [this, &PendingIcons, &PendingTags]()
+	{
+		if (PendingIcons.IsEmpty())
+		{
+			return;
+		}
+		TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+			MoveTemp(PendingIcons),
+			FStreamableDelegate::CreateUObject(this, &UStoreModel::HandleCategoryIconsLoaded, PendingTags));
+		CategoryIconLoadHandles.Add(MoveTemp(Handle));
+		PendingIcons.Reset();
+		PendingTags.Reset();
+	};
+
+	for (const TTuple<FGameplayTag, FCategoryUIDefinition>& Pair : Definitions)
+	{
+		const FCategoryUIDefinition& Definition = Pair.Value;
+		FStandardUIData& UIData = ResolvedCategoryUIData.Add(Pair.Key, FStandardUIData(Definition.DisplayName, Definition.Description, Definition.IconBrush));
+		UIData.Icon.SetResourceObject(Definition.IconResource.Get());
+
+		if (UIData.Icon.GetResourceObject() == nullptr && !Definition.IconResource.IsNull())
+		{
+			PendingIcons.Add(Definition.IconResource.ToSoftObjectPath());
+			PendingTags.Add(Pair.Key);
+			if (PendingIcons.Num() >= CategoryIconLoadBatchSize)
+			{
+				RequestPendingIcons();
+			}
+		}
+	}
+	RequestPendingIcons();
+}
+
+void UStoreModel::HandleCategoryIconsLoaded(TArray<FGameplayTag> LoadedTags)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	const TMap<FGameplayTag, FCategoryUIDefinition>& Definitions = UMolecularUISettings::GetCategoryUIDefinitions();
+	for (const FGameplayTag& CategoryTag : LoadedTags)
+	{
+		const FCategoryUIDefinition* Definition = Definitions.Find(CategoryTag);
+		FStandardUIData* UIData = ResolvedCategoryUIData.Find(CategoryTag);
+		UObject* IconResource = Definition != nullptr ? Definition->IconResource.Get() : nullptr;
+		if (UIData == nullptr || IconResource == nullptr)
+		{
+			UE_LOG(LogMolecularUI, Warning, TEXT("[%hs] Failed to load the icon of category %s."), __FUNCTION__, *CategoryTag.ToString());
+			continue;
+		}
+		UIData->Icon.SetResourceObject(IconResource);
+
+		// Leave ViewModels that were given their own icon alone, e.g. default tabs.
+		const TObjectPtr<UCategoryViewModel>* CategoryVM = CategoryViewModelRegistry.Find(CategoryTag);
+		if (CategoryVM != nullptr && IsValid(*CategoryVM) && (*CategoryVM)->GetUIData().Icon.GetResourceObject() == nullptr)
+		{
+			FStandardUIData NewUIData = (*CategoryVM)->GetUIData();
+			NewUIData.Icon = UIData->Icon;
+			(*CategoryVM)->SetUIData(NewUIData);
+		}
+	}
+}
+
+void UStoreModel::TrimItemViewModelCache()
+{
+	if (ItemViewModelCacheCapacity <= 0 || NumCachedItemViewModels <= ItemViewModelCacheCapacity)
+	{
+		return;
+	}
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	// Anything a view can currently reach has to stay.
+	TSet<const UObject*> Referenced;
+	for (const TObjectPtr<UItemViewModel>& ItemVM : StoreViewModel->GetAvailableItems())
+	{
+		Referenced.Add(ItemVM);
+	}
+	for (const TObjectPtr<UItemViewModel>& ItemVM : StoreViewModel->GetOwnedItems())
+	{
+		Referenced.Add(ItemVM);
+	}
+	for (const UWindowedCollectionViewModel* WindowVM : { AvailableItemsWindow.Get(), OwnedItemsWindow.Get() })
+	{
+		if (IsValid(WindowVM))
+		{
+			for (const TObjectPtr<UMVVMViewModelBase>& ItemVM : WindowVM->GetWindowItems())
+			{
+				Referenced.Add(ItemVM);
+			}
+		}
+	}
+	for (const UInteractiveViewModelBase* SelectedVM : SelectionViewModel_Store->GetSelectedViewModels())
+	{
+		Referenced.Add(SelectedVM);
+	}
+	Referenced.Add(SelectionViewModel_Store->GetPreviewedViewModel());
+	Referenced.Add(SelectionViewModel_Store->GetLastSelectedViewModel());
+
+	struct FEvictionCandidate
+	{
+		int32 SlotIndex;
+		uint64 LastUse;
+	};
+	TArray<FEvictionCandidate> Candidates;
+	for (int32 SlotIndex = 0; SlotIndex < ItemViewModelCache.Num(); ++SlotIndex)
+	{
+		const UItemViewModel* ItemVM = ItemViewModelCache[SlotIndex];
+		if (ItemVM != nullptr && !Referenced.Contains(ItemVM))
+		{
+			Candidates.Add({ SlotIndex, ItemViewModelLastUse[SlotIndex] });
+		}
+	}
+	Algo::SortBy(Candidates, &FEvictionCandidate::LastUse);
+
+	// Evict down to 7/8 of capacity so a cache hovering at the limit doesn't sort on every call.
+	const int32 TargetNum = ItemViewModelCacheCapacity - ItemViewModelCacheCapacity / 8;
+	for (const FEvictionCandidate& Candidate : Candidates)
+	{
+		if (NumCachedItemViewModels <= TargetNum)
+		{
+			break;
+		}
+		UItemViewModel* ItemVM = ItemViewModelCache[Candidate.SlotIndex];
+		ItemViewModelCache[Candidate.SlotIndex] = nullptr;
+		ItemViewModelLastUse[Candidate.SlotIndex] = 0;
+		--NumCachedItemViewModels;
+		RecycleItemViewModel(ItemVM);
+		++ItemViewModelCacheStats.Evictions;
+	}
+}
+
+void UStoreModel::RecycleItemViewModel(UItemViewModel* ItemVM)
+{
+	if (!IsValid(ItemVM))
+	{
+		return;
+	}
+
+	UE_MVVM_UNBIND_FIELD(ItemVM, Interaction);
+
+	// The category ViewModels belong to the registry and stay bound for the other items and tabs sharing them.
+	ItemVM->SetCategoryViewModels({});
+
+	if (ItemViewModelPool.Num() >= ItemViewModelPoolCapacity)
+	{
+		return; // Pool is full, leave this one to GC.
+	}
+
+	ItemVM->ClearInteraction();
+	ItemVM->SetItemData(FStoreItem());
+	ItemViewModelPool.Add(ItemVM);
 }
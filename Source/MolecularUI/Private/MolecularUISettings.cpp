@@ -16,4 +16,9 @@ TSoftObjectPtr<UDataTable> UMolecularUISettings::GetDefaultStoreItemsDataTable()
 const FSlateBrush& UMolecularUISettings::GetDefaultStoreIcon()
 {
 	return Get()->DefaultStoreIcon;
+}
+
+const TMap<FGameplayTag, FCategoryUIDefinition>& UMolecularUISettings::GetCategoryUIDefinitions()
+{
+	return Get()->CategoryUIDefinitions;
 }
\ No newline at end of file
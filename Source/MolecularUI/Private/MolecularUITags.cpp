@@ -13,6 +13,7 @@ namespace MolecularUITags
 				UE_DEFINE_GAMEPLAY_TAG(Items, "Store.State.Loading.Items");
 				UE_DEFINE_GAMEPLAY_TAG(OwnedItems, "Store.State.Loading.OwnedItems");
 				UE_DEFINE_GAMEPLAY_TAG(Currency, "Store.State.Loading.Currency");
+				UE_DEFINE_GAMEPLAY_TAG(Changes, "Store.State.Loading.Changes");
 			}
 			UE_DEFINE_GAMEPLAY_TAG(None, "Store.State.None");
 			UE_DEFINE_GAMEPLAY_TAG(Ready, "Store.State.Ready");
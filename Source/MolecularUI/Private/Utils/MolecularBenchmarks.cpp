@@ -0,0 +1,360 @@
+// Copyright Mike Desrosiers, All Rights Reserved.
+
+#include <CoreMinimal.h>
+
+#if !UE_BUILD_SHIPPING
+
+#include <HAL/IConsoleManager.h>
+#include <HAL/MemoryBase.h>
+#include <HAL/PlatformTime.h>
+#include <atomic>
+#include <UObject/Package.h>
+
+#include "Models/StoreCatalogIndex.h"
+#include "Models/StoreModel.h"
+#include "Utils/LogMolecularUI.h"
+#include "ViewModels/StoreViewModel.h"
+
+/**
+ * Passes every call through to the engine allocator and counts the allocating ones while it is installed as GMalloc.
+ * Allocations made by other threads in the meantime are counted too, so the figures are an upper bound.
+ */
+class FMolecularCountingMalloc final : public FMalloc
+{
+public:
+	// Counts the allocations Func makes. Not reentrant.
+	static int64 Count(TFunctionRef<void()> Func)
+	{
+		// Kept alive for good, a thread may still be inside it after GMalloc is restored.
+		static FMolecularCountingMalloc Counter;
+		Counter.Inner = GMalloc;
+		Counter.NumAllocations = 0;
+		GMalloc = &Counter;
+		Func();
+		GMalloc = Counter.Inner;
+		return Counter.NumAllocations;
+	}
+
+	virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+	{
+		++NumAllocations;
+		return Inner->Malloc(Count, Alignment);
+	}
+
+	virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+	{
+		++NumAllocations;
+		return Inner->Realloc(Original, Count, Alignment);
+	}
+
+	virtual void Free(void* Original) override { Inner->Free(Original); }
+	virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+	virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+	virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+	virtual const TCHAR* GetDescriptiveName() override { return TEXT("MolecularCountingMalloc"); }
+
+private:
+	FMalloc* Inner = nullptr;
+	std::atomic<int64> NumAllocations{ 0 };
+};
+
+/**
+ * Development-only measurements of the store model's hot paths, run from the console.
+ * Results are logged to LogMolecularUI.
+ */
+struct FStoreModelBenchmark
+{
+	// Item counts from the command arguments, or the default sizes.
+	static TArray<int32> ParseSizes(const TArray<FString>& Args)
+	{
+		TArray<int32> Sizes;
+		for (const FString& Arg : Args)
+		{
+			Sizes.Add(FMath::Max(1, FCString::Atoi(*Arg)));
+		}
+		if (Sizes.IsEmpty())
+		{
+			Sizes = { 10000, 50000, 100000 };
+		}
+		return Sizes;
+	}
+
+	// Catalog of NumItems unique items spread over the item categories, every seventh one owned.
+	static TArray<FStoreItem> MakeItems(const int32 NumItems)
+	{
+		const FGameplayTag CategoryTags[] = {
+			MolecularUITags::Item::Category::Consumable,
+			MolecularUITags::Item::Category::Equipment,
+			MolecularUITags::Item::Category::Resource,
+			MolecularUITags::Item::Category::Other };
+
+		TArray<FStoreItem> Items;
+		Items.Reserve(NumItems);
+		for (int32 Index = 0; Index < NumItems; ++Index)
+		{
+			FStoreItem& Item = Items.AddDefaulted_GetRef();
+			Item.ItemId = FName(TEXT("BenchItem"), Index + 1);
+			Item.Cost = 10 + Index % 1000;
+			Item.bIsOwned = Index % 7 == 0;
+			Item.UIData.DisplayName = FText::FromName(Item.ItemId);
+			Item.Categories.AddTag(CategoryTags[Index % UE_ARRAY_COUNT(CategoryTags)]);
+		}
+		UStoreModel::StampContentHashes(Items);
+		return Items;
+	}
+
+	// A model with just enough state to create ItemViewModels. The cache is left unbounded so every size measures creation only.
+	static UStoreModel* MakeModel()
+	{
+		UStoreModel* Model = NewObject<UStoreModel>(GetTransientPackage());
+		Model->StoreViewModel = NewObject<UStoreViewModel>(Model);
+		Model->ItemViewModelCacheCapacity = 0;
+		return Model;
+	}
+
+	/**
+	 * Times GetOrCreateItemViewModels on a cold and a warm cache, which is what LazyLoadOwnedItems does per response,
+	 * and the handle assignment and dedupe a store page goes through before it is indexed.
+	 */
+	static void RunIngest(const TArray<FString>& Args)
+	{
+		for (const int32 NumItems : ParseSizes(Args))
+		{
+			// Every tenth item repeated at the end, as a misbehaving backend would send them.
+			TArray<FStoreItem> Items = MakeItems(NumItems);
+			for (int32 Index = 0; Index < NumItems; Index += 10)
+			{
+				const FStoreItem Repeated = Items[Index];
+				Items.Add(Repeated);
+			}
+			UStoreModel* Model = MakeModel();
+
+			double StartTime = FPlatformTime::Seconds();
+			const int32 NumViewModels = Model->GetOrCreateItemViewModels(Items).Num();
+			const double ColdMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+			StartTime = FPlatformTime::Seconds();
+			Model->GetOrCreateItemViewModels(Items);
+			const double WarmMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+			// The same rows as a single store page.
+			TArray<FStoreItem> PageRows = Items;
+			StartTime = FPlatformTime::Seconds();
+			Model->LoadedPageHandles.Reset();
+			Model->AssignItemHandles(PageRows);
+			Model->DropRepeatedItems(PageRows, 0);
+			const double PageMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+			ensureMsgf(PageRows.Num() == NumViewModels, TEXT("The store page kept %d rows, expected %d"), PageRows.Num(), NumViewModels);
+
+			// Linear growth shows as a flat per-1k figure across sizes.
+			UE_LOG(LogMolecularUI, Display, TEXT("[%hs] %d items (%d unique): cold %.2f ms (%.3f ms per 1k), warm %.2f ms (%.3f ms per 1k), store page %.2f ms (%.3f ms per 1k)"),
+				__FUNCTION__, Items.Num(), NumViewModels,
+				ColdMs, ColdMs * 1000.0 / Items.Num(),
+				WarmMs, WarmMs * 1000.0 / Items.Num(),
+				PageMs, PageMs * 1000.0 / Items.Num());
+
+			Model->MarkAsGarbage();
+		}
+	}
+
+	/**
+	 * Runs the same owned, cost and category predicate over the catalog array and over the index's hot columns.
+	 * Hardware cache counters aren't portable, so the log reports the bytes each pass strides over per item next to
+	 * its time. Both passes are repeated so the catalog is cache-cold for every size past the last-level cache.
+	 */
+	static void RunCatalogScan(const TArray<FString>& Args)
+	{
+		constexpr int32 NumPasses = 20;
+		const FGameplayTag QueryTag = MolecularUITags::Item::Category::Equipment;
+		FGameplayTagContainer QueryTags(QueryTag);
+
+		for (const int32 NumItems : ParseSizes(Args))
+		{
+			const TArray<FStoreItem> Items = MakeItems(NumItems);
+			FStoreCatalogIndex Index;
+			Index.Build(Items);
+
+			int32 RowMatches = 0;
+			double StartTime = FPlatformTime::Seconds();
+			for (int32 Pass = 0; Pass < NumPasses; ++Pass)
+			{
+				RowMatches = 0;
+				for (const FStoreItem& Item : Items)
+				{
+					RowMatches += !Item.bIsOwned && Item.Cost >= 100 && Item.Cost <= 500 && Item.Categories.HasTag(QueryTag);
+				}
+			}
+			const double RowMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumPasses;
+
+			const FStoreCatalogColumns& Columns = Index.Columns;
+			const uint64 QueryMask = FStoreCatalogColumns::MakeCategoryMask(QueryTags, Index.CategoryIndex);
+			int32 ColumnMatches = 0;
+			StartTime = FPlatformTime::Seconds();
+			for (int32 Pass = 0; Pass < NumPasses; ++Pass)
+			{
+				ColumnMatches = 0;
+				for (int32 ItemIndex = 0; ItemIndex < Columns.Num(); ++ItemIndex)
+				{
+					ColumnMatches += !Columns.IsOwned(ItemIndex) && Columns.IsCostInRange(ItemIndex, 100, 500) && Columns.MatchesCategoryMask(ItemIndex, QueryMask);
+				}
+			}
+			const double ColumnMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumPasses;
+
+			ensureMsgf(RowMatches == ColumnMatches, TEXT("Row and column scans disagree: %d vs %d"), RowMatches, ColumnMatches);
+			UE_LOG(LogMolecularUI, Display, TEXT("[%hs] %d items, %d matches: rows %.3f ms (%d bytes per item), columns %.3f ms (%d bytes and a bit per item), %.1fx"),
+				__FUNCTION__, NumItems, ColumnMatches,
+				RowMs, static_cast<int32>(sizeof(FStoreItem)),
+				ColumnMs, static_cast<int32>(sizeof(int32) + sizeof(uint64)),
+				ColumnMs > 0.0 ? RowMs / ColumnMs : 0.0);
+		}
+	}
+
+	/**
+	 * Times fuzzy filter passes over the whole catalog: a query with typos, a clean prefix and one the character masks
+	 * reject outright. Each pass is timed alone and again with the facet counts taken from the same scoring pass.
+	 * The target is 1 ms per pass at 20k items.
+	 */
+	static void RunFuzzy(const TArray<FString>& Args)
+	{
+		constexpr int32 NumPasses = 20;
+		const TCHAR* Queries[] = { TEXT("bnechitem 42"), TEXT("benchitem_1"), TEXT("qzxj") };
+
+		const TArray<int32> Sizes = Args.IsEmpty() ? TArray<int32>{ 20000, 50000, 100000 } : ParseSizes(Args);
+		for (const int32 NumItems : Sizes)
+		{
+			FStoreCatalogIndex Index;
+			Index.Build(MakeItems(NumItems));
+
+			for (const TCHAR* QueryText : Queries)
+			{
+				FStoreFilterQuery Query;
+				Query.FoldedText = FStoreTextIndex::FoldText(QueryText);
+				Query.SearchMode = EStoreSearchMode::Fuzzy;
+				Query.MaxFuzzyResults = 200;
+
+				TArray<int32> Matches;
+				double StartTime = FPlatformTime::Seconds();
+				for (int32 Pass = 0; Pass < NumPasses; ++Pass)
+				{
+					Index.Match(Query, nullptr, Matches, /*bParallel*/ false);
+				}
+				const double MatchMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumPasses;
+
+				FStoreFacetCounts Facets;
+				StartTime = FPlatformTime::Seconds();
+				for (int32 Pass = 0; Pass < NumPasses; ++Pass)
+				{
+					Index.Match(Query, nullptr, Matches, /*bParallel*/ false, &Facets);
+				}
+				const double FacetsMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumPasses;
+
+				UE_LOG(LogMolecularUI, Display, TEXT("[%hs] %d items, '%s' (%s): %d kept of %d matches, match %.3f ms, match and facets %.3f ms"),
+					__FUNCTION__, NumItems, QueryText, FStoreFuzzyIndex::GetKernelName(), Matches.Num(), Facets.Total, MatchMs, FacetsMs);
+			}
+		}
+	}
+
+	/**
+	 * Counts the allocations of an owned items refresh, from the provider's list to CachedOwnedItems, once with nothing
+	 * changed and once with one item changed. The per-response path is the one before snapshots: the provider copies its
+	 * list into the response, the callback takes another copy and the model copies that into its cache. The snapshot
+	 * path creates a snapshot only when the provider's list changed, as the mock does, and hands it to IngestOwnedItems.
+	 * Each path counts its own creation. The full list isn't published, so ViewModel work is left out of both.
+	 */
+	static void RunRefreshAllocations(const TArray<FString>& Args)
+	{
+		for (const int32 NumItems : ParseSizes(Args))
+		{
+			TArray<FStoreItem> BackendRows = MakeItems(NumItems);
+			for (FStoreItem& Item : BackendRows)
+			{
+				Item.bIsOwned = true;
+				Item.UpdateContentHash();
+			}
+			TArray<FStoreItem> ChangedRows = BackendRows;
+			ChangedRows[NumItems / 2].Cost += 1;
+			ChangedRows[NumItems / 2].UpdateContentHash();
+
+			UStoreModel* Model = MakeModel();
+			Model->bPublishFullItemLists = false;
+
+			auto CountPerResponse = [Model](const TArray<FStoreItem>& ProviderRows, double& OutMs)
+			{
+				const double StartTime = FPlatformTime::Seconds();
+				const int64 Allocations = FMolecularCountingMalloc::Count([Model, &ProviderRows]()
+				{
+					TArray<FStoreItem> Response = ProviderRows;
+					auto OnSuccess = [Model](TArray<FStoreItem> Received)
+					{
+						Model->CachedOwnedItems = Received;
+						Model->StampContentHashes(Model->CachedOwnedItems);
+						Model->AssignItemHandles(Model->CachedOwnedItems);
+					};
+					OnSuccess(Response);
+				});
+				OutMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+				return Allocations;
+			};
+
+			// The provider holds the snapshot of its current list, and only a changed list makes a new one.
+			TSharedPtr<const FStoreCatalogSnapshot> ProviderSnapshot;
+			auto CountSnapshot = [Model, &ProviderSnapshot](const TArray<FStoreItem>* ChangedProviderRows, double& OutMs)
+			{
+				const double StartTime = FPlatformTime::Seconds();
+				const int64 Allocations = FMolecularCountingMalloc::Count([Model, &ProviderSnapshot, ChangedProviderRows]()
+				{
+					if (ChangedProviderRows != nullptr)
+					{
+						ProviderSnapshot = FStoreCatalogSnapshot::Create(CopyTemp(*ChangedProviderRows), 0);
+					}
+					Model->IngestOwnedItems(ProviderSnapshot.ToSharedRef());
+				});
+				OutMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+				return Allocations;
+			};
+
+			// Both paths start from a cache holding the provider's current list.
+			double CopiedUnchangedMs = 0.0;
+			double CopiedChangedMs = 0.0;
+			double SharedUnchangedMs = 0.0;
+			double SharedChangedMs = 0.0;
+			CountPerResponse(BackendRows, CopiedUnchangedMs);
+			const int64 CopiedUnchanged = CountPerResponse(BackendRows, CopiedUnchangedMs);
+			const int64 CopiedChanged = CountPerResponse(ChangedRows, CopiedChangedMs);
+
+			Model->CachedOwnedItems.Reset();
+			CountSnapshot(&BackendRows, SharedUnchangedMs);
+			const int64 SharedUnchanged = CountSnapshot(nullptr, SharedUnchangedMs);
+			const int64 SharedChanged = CountSnapshot(&ChangedRows, SharedChangedMs);
+
+			UE_LOG(LogMolecularUI, Display, TEXT("[%hs] %d owned items, unchanged: per-response copies %lld allocations (%.2f ms), shared snapshot %lld allocations (%.3f ms)"),
+				__FUNCTION__, NumItems, CopiedUnchanged, CopiedUnchangedMs, SharedUnchanged, SharedUnchangedMs);
+			UE_LOG(LogMolecularUI, Display, TEXT("[%hs] %d owned items, one changed: per-response copies %lld allocations (%.2f ms), shared snapshot %lld allocations (%.2f ms)"),
+				__FUNCTION__, NumItems, CopiedChanged, CopiedChangedMs, SharedChanged, SharedChangedMs);
+
+			Model->MarkAsGarbage();
+		}
+	}
+};
+
+static FAutoConsoleCommand CmdBenchmarkIngest(
+	TEXT("MolecularUI.Benchmark.Ingest"),
+	TEXT("Times creating the ItemViewModels of a received item list. Optional args: item counts, default 10000 50000 100000."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&FStoreModelBenchmark::RunIngest));
+
+static FAutoConsoleCommand CmdBenchmarkRefreshAllocations(
+	TEXT("MolecularUI.Benchmark.RefreshAllocations"),
+	TEXT("Counts the allocations of an owned items refresh, unchanged and with one item changed, copied per response versus shared. Optional args: item counts, default 10000 50000 100000."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&FStoreModelBenchmark::RunRefreshAllocations));
+
+static FAutoConsoleCommand CmdBenchmarkCatalogScan(
+	TEXT("MolecularUI.Benchmark.CatalogScan"),
+	TEXT("Compares a filter predicate over the catalog rows against the hot columns. Optional args: item counts, default 10000 50000 100000."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&FStoreModelBenchmark::RunCatalogScan));
+
+static FAutoConsoleCommand CmdBenchmarkFuzzy(
+	TEXT("MolecularUI.Benchmark.Fuzzy"),
+	TEXT("Times fuzzy filter passes, alone and with facet counts. Optional args: item counts, default 20000 50000 100000."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&FStoreModelBenchmark::RunFuzzy));
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,326 @@
+// Copyright Mike Desrosiers, All Rights Reserved.
+
+#include "Utils/MolecularBitmap.h"
+
+#include <Algo/BinarySearch.h>
+
+void FMolecularBitmap::Add(const int32 Value)
+{
+	check(Value >= 0);
+	const uint16 Key = static_cast<uint16>(static_cast<uint32>(Value) >> 16);
+	const uint16 Low = static_cast<uint16>(Value & 0xFFFF);
+
+	// Values are usually added in ascending order, so check the last container before searching.
+	int32 ContainerIndex = Containers.Num() - 1;
+	if (Containers.IsEmpty() || Containers.Last().Key != Key)
+	{
+		ContainerIndex = Algo::LowerBoundBy(Containers, Key, &FContainer::Key);
+		if (!Containers.IsValidIndex(ContainerIndex) || Containers[ContainerIndex].Key != Key)
+		{
+			FContainer NewContainer;
+			NewContainer.Key = Key;
+			Containers.Insert(MoveTemp(NewContainer), ContainerIndex);
+		}
+	}
+
+	FContainer& Container = Containers[ContainerIndex];
+	if (Container.IsBitmap())
+	{
+		uint64& Word = Container.Words[Low >> 6];
+		const uint64 Mask = 1ull << (Low & 63);
+		if ((Word & Mask) == 0)
+		{
+			Word |= Mask;
+			++Container.Cardinality;
+		}
+		return;
+	}
+
+	const int32 InsertIndex = (Container.Values.IsEmpty() || Container.Values.Last() < Low)
+		? Container.Values.Num()
+		: Algo::LowerBound(Container.Values, Low);
+	if (Container.Values.IsValidIndex(InsertIndex) && Container.Values[InsertIndex] == Low)
+	{
+		return;
+	}
+	Container.Values.Insert(Low, InsertIndex);
+	++Container.Cardinality;
+
+	if (Container.Cardinality > MaxArrayCardinality)
+	{
+		Container.ConvertToBitmap();
+	}
+}
+
+void FMolecularBitmap::Remove(const int32 Value)
+{
+	if (Value < 0)
+	{
+		return;
+	}
+	const int32 ContainerIndex = Algo::BinarySearchBy(Containers, static_cast<uint16>(static_cast<uint32>(Value) >> 16), &FContainer::Key);
+	if (ContainerIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	FContainer& Container = Containers[ContainerIndex];
+	const uint16 Low = static_cast<uint16>(Value & 0xFFFF);
+	if (Container.IsBitmap())
+	{
+		uint64& Word = Container.Words[Low >> 6];
+		const uint64 Mask = 1ull << (Low & 63);
+		if ((Word & Mask) == 0)
+		{
+			return;
+		}
+		Word &= ~Mask;
+		--Container.Cardinality;
+
+		// Well below the threshold Add converts at, so a container near it doesn't flip on every change.
+		if (Container.Cardinality <= MaxArrayCardinality / 2)
+		{
+			Container.ConvertToArray();
+		}
+	}
+	else
+	{
+		const int32 ValueIndex = Algo::BinarySearch(Container.Values, Low);
+		if (ValueIndex == INDEX_NONE)
+		{
+			return;
+		}
+		Container.Values.RemoveAt(ValueIndex, 1, EAllowShrinking::No);
+		--Container.Cardinality;
+	}
+
+	if (Container.Cardinality == 0)
+	{
+		Containers.RemoveAt(ContainerIndex);
+	}
+}
+
+bool FMolecularBitmap::Contains(const int32 Value) const
+{
+	if (Value < 0)
+	{
+		return false;
+	}
+	const FContainer* Container = FindContainer(static_cast<uint16>(static_cast<uint32>(Value) >> 16));
+	return Container != nullptr && Container->Contains(static_cast<uint16>(Value & 0xFFFF));
+}
+
+int32 FMolecularBitmap::Num() const
+{
+	int32 Count = 0;
+	for (const FContainer& Container : Containers)
+	{
+		Count += Container.Cardinality;
+	}
+	return Count;
+}
+
+FMolecularBitmap& FMolecularBitmap::operator|=(const FMolecularBitmap& Other)
+{
+	if (&Other == this)
+	{
+		return *this;
+	}
+
+	TArray<FContainer> Merged;
+	Merged.Reserve(Containers.Num() + Other.Containers.Num());
+
+	int32 IndexA = 0;
+	int32 IndexB = 0;
+	while (IndexA < Containers.Num() || IndexB < Other.Containers.Num())
+	{
+		if (IndexB >= Other.Containers.Num() || (IndexA < Containers.Num() && Containers[IndexA].Key < Other.Containers[IndexB].Key))
+		{
+			Merged.Add(MoveTemp(Containers[IndexA++]));
+			continue;
+		}
+		if (IndexA >= Containers.Num() || Other.Containers[IndexB].Key < Containers[IndexA].Key)
+		{
+			Merged.Add(Other.Containers[IndexB++]);
+			continue;
+		}
+
+		FContainer& A = Containers[IndexA++];
+		const FContainer& B = Other.Containers[IndexB++];
+		FContainer& Result = Merged.Add_GetRef(MoveTemp(A));
+
+		if (Result.IsBitmap() || B.IsBitmap() || Result.Cardinality + B.Cardinality > MaxArrayCardinality)
+		{
+			Result.ConvertToBitmap();
+			if (B.IsBitmap())
+			{
+				for (int32 WordIndex = 0; WordIndex < NumBitmapWords; ++WordIndex)
+				{
+					Result.Words[WordIndex] |= B.Words[WordIndex];
+				}
+			}
+			else
+			{
+				for (const uint16 Low : B.Values)
+				{
+					Result.Words[Low >> 6] |= 1ull << (Low & 63);
+				}
+			}
+
+			Result.Cardinality = 0;
+			for (const uint64 Word : Result.Words)
+			{
+				Result.Cardinality += FPlatformMath::CountBits(Word);
+			}
+		}
+		else
+		{
+			// Both sparse: merge the sorted arrays.
+			TArray<uint16> Values;
+			Values.Reserve(Result.Cardinality + B.Cardinality);
+			int32 ValueA = 0;
+			int32 ValueB = 0;
+			while (ValueA < Result.Values.Num() || ValueB < B.Values.Num())
+			{
+				if (ValueB >= B.Values.Num() || (ValueA < Result.Values.Num() && Result.Values[ValueA] < B.Values[ValueB]))
+				{
+					Values.Add(Result.Values[ValueA++]);
+				}
+				else if (ValueA >= Result.Values.Num() || B.Values[ValueB] < Result.Values[ValueA])
+				{
+					Values.Add(B.Values[ValueB++]);
+				}
+				else
+				{
+					Values.Add(Result.Values[ValueA++]);
+					++ValueB;
+				}
+			}
+			Result.Values = MoveTemp(Values);
+			Result.Cardinality = Result.Values.Num();
+		}
+	}
+
+	Containers = MoveTemp(Merged);
+	return *this;
+}
+
+FMolecularBitmap& FMolecularBitmap::operator&=(const FMolecularBitmap& Other)
+{
+	if (&Other == this)
+	{
+		return *this;
+	}
+
+	TArray<FContainer> Intersected;
+
+	int32 IndexB = 0;
+	for (FContainer& A : Containers)
+	{
+		while (IndexB < Other.Containers.Num() && Other.Containers[IndexB].Key < A.Key)
+		{
+			++IndexB;
+		}
+		if (IndexB >= Other.Containers.Num())
+		{
+			break;
+		}
+		const FContainer& B = Other.Containers[IndexB];
+		if (B.Key != A.Key)
+		{
+			continue;
+		}
+
+		FContainer Result;
+		Result.Key = A.Key;
+		if (A.IsBitmap() && B.IsBitmap())
+		{
+			Result.Words.SetNumUninitialized(NumBitmapWords);
+			for (int32 WordIndex = 0; WordIndex < NumBitmapWords; ++WordIndex)
+			{
+				Result.Words[WordIndex] = A.Words[WordIndex] & B.Words[WordIndex];
+				Result.Cardinality += FPlatformMath::CountBits(Result.Words[WordIndex]);
+			}
+			if (Result.Cardinality <= MaxArrayCardinality)
+			{
+				Result.ConvertToArray();
+			}
+		}
+		else
+		{
+			// At least one side is sparse, so the result is too. Walk the sparse side and probe the other.
+			const FContainer& Sparse = A.IsBitmap() ? B : A;
+			const FContainer& Probe = A.IsBitmap() ? A : B;
+			for (const uint16 Low : Sparse.Values)
+			{
+				if (Probe.Contains(Low))
+				{
+					Result.Values.Add(Low);
+				}
+			}
+			Result.Cardinality = Result.Values.Num();
+		}
+
+		if (Result.Cardinality > 0)
+		{
+			Intersected.Add(MoveTemp(Result));
+		}
+	}
+
+	Containers = MoveTemp(Intersected);
+	return *this;
+}
+
+void FMolecularBitmap::ToArray(TArray<int32>& OutValues) const
+{
+	OutValues.Reserve(OutValues.Num() + Num());
+	ForEach([&OutValues](const int32 Value) { OutValues.Add(Value); });
+}
+
+const FMolecularBitmap::FContainer* FMolecularBitmap::FindContainer(const uint16 Key) const
+{
+	const int32 ContainerIndex = Algo::BinarySearchBy(Containers, Key, &FContainer::Key);
+	return ContainerIndex != INDEX_NONE ? &Containers[ContainerIndex] : nullptr;
+}
+
+bool FMolecularBitmap::FContainer::Contains(const uint16 Low) const
+{
+	if (IsBitmap())
+	{
+		return (Words[Low >> 6] & (1ull << (Low & 63))) != 0;
+	}
+	return Algo::BinarySearch(Values, Low) != INDEX_NONE;
+}
+
+void FMolecularBitmap::FContainer::ConvertToBitmap()
+{
+	if (IsBitmap())
+	{
+		return;
+	}
+	Words.SetNumZeroed(NumBitmapWords);
+	for (const uint16 Low : Values)
+	{
+		Words[Low >> 6] |= 1ull << (Low & 63);
+	}
+	Values.Empty();
+}
+
+void FMolecularBitmap::FContainer::ConvertToArray()
+{
+	if (!IsBitmap())
+	{
+		return;
+	}
+	Values.Reset(Cardinality);
+	for (int32 WordIndex = 0; WordIndex < Words.Num(); ++WordIndex)
+	{
+		uint64 Word = Words[WordIndex];
+		while (Word != 0)
+		{
+			Values.Add(static_cast<uint16>((WordIndex << 6) | FPlatformMath::CountTrailingZeros64(Word)));
+			Word &= Word - 1;
+		}
+	}
+	Words.Empty();
+}
@@ -60,6 +60,27 @@ namespace MolecularUI::CVars
 			MaxDelay,
 			TEXT("Maximum delay for FetchStoreItems in seconds."),
 			ECVF_Cheat);
+
+		float PageMinDelay = 0.02f;
+		static FAutoConsoleVariableRef CVarPageMinDelay(
+			TEXT("MolecularUI.Store.PageMinDelay"),
+			PageMinDelay,
+			TEXT("Minimum delay for each FetchStoreItemsPage call after the first, in seconds."),
+			ECVF_Cheat);
+
+		float PageMaxDelay = 0.1f;
+		static FAutoConsoleVariableRef CVarPageMaxDelay(
+			TEXT("MolecularUI.Store.PageMaxDelay"),
+			PageMaxDelay,
+			TEXT("Maximum delay for each FetchStoreItemsPage call after the first, in seconds."),
+			ECVF_Cheat);
+
+		float FilterDebounceSeconds = 0.0f;
+		static FAutoConsoleVariableRef CVarFilterDebounceSeconds(
+			TEXT("MolecularUI.Store.FilterDebounceSeconds"),
+			FilterDebounceSeconds,
+			TEXT("Quiet period after the last filter text change before the store is filtered, in seconds. 0 filters at the end of the same tick."),
+			ECVF_Default);
 	}
 
 	// Owned items operations
@@ -0,0 +1,347 @@
+// Copyright Mike Desrosiers, All Rights Reserved.
+
+#include <CoreMinimal.h>
+
+#if !UE_BUILD_SHIPPING
+
+#include <Algo/IsSorted.h>
+#include <Algo/Sort.h>
+#include <Engine/GameInstance.h>
+#include <Engine/World.h>
+#include <HAL/IConsoleManager.h>
+#include <TimerManager.h>
+#include <UObject/Package.h>
+#include <UObject/StrongObjectPtr.h>
+#include <UObject/UObjectIterator.h>
+
+#include "DataProviders/MockStoreDataProviderSubsystem.h"
+#include "DataProviders/StoreDataProviderMultiplexer.h"
+#include "Models/StoreCatalogIndex.h"
+#include "Models/StoreModel.h"
+#include "MolecularUITags.h"
+#include "Utils/LogMolecularUI.h"
+#include "ViewModels/StoreViewModel.h"
+
+/**
+ * Development-only regression checks of the store model, run from the console.
+ * Each one ensures on the first expectation it finds broken and logs its outcome to LogMolecularUI.
+ */
+struct FStoreModelChecks
+{
+	// Catalog of NumItems available items, named so that sorting by name reverses catalog order.
+	static TArray<FStoreItem> MakeItems(const int32 NumItems)
+	{
+		TArray<FStoreItem> Items;
+		Items.Reserve(NumItems);
+		for (int32 Index = 0; Index < NumItems; ++Index)
+		{
+			FStoreItem& Item = Items.AddDefaulted_GetRef();
+			Item.ItemId = FName(TEXT("CheckItem"), Index + 1);
+			Item.Cost = 10 + Index;
+			Item.UIData.DisplayName = FText::FromString(FString::Printf(TEXT("Check Item %04d"), NumItems - Index));
+			Item.Categories.AddTag(MolecularUITags::Item::Category::Other);
+		}
+		return Items;
+	}
+
+	static void Report(const ANSICHAR* CheckName, const bool bPassed)
+	{
+		UE_LOG(LogMolecularUI, Display, TEXT("[%hs] %s"), CheckName, bPassed ? TEXT("Passed") : TEXT("FAILED"));
+	}
+
+	// Switching the sort back to None refines the sorted matches, which must come back in catalog order.
+	static void RunSortToNone()
+	{
+		const TArray<FStoreItem> Items = MakeItems(64);
+		FStoreCatalogIndex Index;
+		Index.Build(Items);
+
+		FStoreFilterQuery SortedQuery;
+		SortedQuery.SortMode = FStoreSortMode(EStoreSortField::Name);
+		TArray<int32> SortedMatches;
+		Index.Match(SortedQuery, nullptr, SortedMatches, /*bParallel*/ false);
+
+		FStoreFilterQuery UnsortedQuery = SortedQuery;
+		UnsortedQuery.SortMode = FStoreSortMode();
+		TArray<int32> RefinedMatches;
+		Index.Match(UnsortedQuery, UnsortedQuery.IsNarrowingOf(SortedQuery) ? &SortedMatches : nullptr, RefinedMatches, /*bParallel*/ false);
+		TArray<int32> FreshMatches;
+		Index.Match(UnsortedQuery, nullptr, FreshMatches, /*bParallel*/ false);
+
+		const bool bPassed = ensureMsgf(SortedMatches.Num() == Items.Num() && !Algo::IsSorted(SortedMatches), TEXT("Sorting by name should reorder the catalog"))
+			&& ensureMsgf(RefinedMatches == FreshMatches && Algo::IsSorted(RefinedMatches), TEXT("Sort None should restore catalog order"));
+		Report(__FUNCTION__, bPassed);
+	}
+
+	// Handles of the matches, which compare across indexes whose rows sit at different positions.
+	static TArray<FStoreItemHandle> MatchHandles(const FStoreCatalogIndex& Index, const FStoreFilterQuery& Query)
+	{
+		TArray<int32> Matches;
+		Index.Match(Query, nullptr, Matches, /*bParallel*/ false);
+		TArray<FStoreItemHandle> Handles;
+		Handles.Reserve(Matches.Num());
+		for (const int32 ItemIndex : Matches)
+		{
+			Handles.Add(Index.Columns.Handles[ItemIndex]);
+		}
+		return Handles;
+	}
+
+	// A change set patched into the index must match and sort like an index built from the changed catalog.
+	static void RunPatchedIndex()
+	{
+		TArray<FStoreItem> Items = MakeItems(64);
+		for (int32 ItemIndex = 0; ItemIndex < Items.Num(); ++ItemIndex)
+		{
+			Items[ItemIndex].Handle = FStoreItemHandle(ItemIndex, 1);
+		}
+		FStoreCatalogIndex PatchedIndex;
+		PatchedIndex.Build(Items);
+
+		// Renames, a cost that ties with another item, a category change, two removals and two new items.
+		Items[3].UIData.DisplayName = FText::FromString(TEXT("Check Item 9999"));
+		Items[5].Cost = Items[40].Cost;
+		Items[9].Categories.Reset();
+		Items[9].Categories.AddTag(MolecularUITags::Item::Category::Equipment);
+		const TArray<int32> ChangedItems = { 3, 5, 9 };
+		const TArray<int32> RemovedItems = { 7, 20 };
+		TArray<FStoreItem> NewItems = MakeItems(2);
+		for (FStoreItem& NewItem : NewItems)
+		{
+			NewItem.Handle = FStoreItemHandle(Items.Num(), 1);
+			NewItem.ItemId = FName(TEXT("CheckNewItem"), Items.Num());
+			Items.Add(MoveTemp(NewItem));
+		}
+		PatchedIndex.ApplyChanges(Items, ChangedItems, RemovedItems);
+
+		TArray<FStoreItem> ChangedCatalog;
+		for (int32 ItemIndex = 0; ItemIndex < Items.Num(); ++ItemIndex)
+		{
+			if (!RemovedItems.Contains(ItemIndex))
+			{
+				ChangedCatalog.Add(Items[ItemIndex]);
+			}
+		}
+		FStoreCatalogIndex BuiltIndex;
+		BuiltIndex.Build(ChangedCatalog);
+
+		bool bPassed = ensureMsgf(PatchedIndex.FindItemIndex(Items[7].Handle) == INDEX_NONE, TEXT("A removed item should not be found"))
+			&& ensureMsgf(PatchedIndex.FindItemSlot(Items[7].Handle) == 7, TEXT("A removed item should keep its position"));
+		for (const EStoreSortField Field : { EStoreSortField::None, EStoreSortField::Cost, EStoreSortField::Name, EStoreSortField::Category })
+		{
+			for (const TCHAR* Text : { TEXT(""), TEXT("item 00"), TEXT("9999") })
+			{
+				FStoreFilterQuery Query;
+				Query.FoldedText = FStoreTextIndex::FoldText(Text);
+				Query.SortMode = FStoreSortMode(Field, /*bInDescending*/ Field == EStoreSortField::Cost);
+				bPassed = bPassed && ensureMsgf(MatchHandles(PatchedIndex, Query) == MatchHandles(BuiltIndex, Query),
+					TEXT("Patched and built indexes disagree for '%s' sorted by field %d"), Text, static_cast<int32>(Field));
+			}
+		}
+		Report(__FUNCTION__, bPassed);
+	}
+
+	// The store model of the game World runs in, once its catalog is indexed.
+	static UStoreModel* FindStoreModel(UWorld* World)
+	{
+		UGameInstance* GameInstance = World != nullptr ? World->GetGameInstance() : nullptr;
+		for (TObjectIterator<UStoreModel> It; It && GameInstance != nullptr; ++It)
+		{
+			if (It->GetTypedOuter<UGameInstance>() == GameInstance && It->CatalogIndex.IsValid())
+			{
+				return *It;
+			}
+		}
+		return nullptr;
+	}
+
+	/**
+	 * Buys two items back to back on the live store model, the second while the first is still in flight, and rolls the
+	 * second back as a rejected purchase would. The first has to stay bought, the second has to be back in the store and
+	 * the currency has to reflect the first alone. The first is rolled back at the end, so the provider is never asked.
+	 */
+	static void RunBackToBackPurchases(UWorld* World)
+	{
+		UStoreModel* Model = FindStoreModel(World);
+		if (Model == nullptr || !Model->StoreViewModel->HasStoreState(MolecularUITags::Store::State::Ready))
+		{
+			UE_LOG(LogMolecularUI, Error, TEXT("[%hs] Needs a running game with a loaded, ready store."), __FUNCTION__);
+			return;
+		}
+		const FStoreCatalogIndex& Index = *Model->CatalogIndex;
+		UStoreViewModel* StoreVM = Model->StoreViewModel;
+		const int32 StartCurrency = StoreVM->GetPlayerCurrency();
+
+		// The two cheapest available items, so the player can afford both.
+		TArray<int32> AvailableItems;
+		for (int32 ItemIndex = 0; ItemIndex < Index.Num(); ++ItemIndex)
+		{
+			if (Index.Columns.IsAvailable(ItemIndex))
+			{
+				AvailableItems.Add(ItemIndex);
+			}
+		}
+		Algo::SortBy(AvailableItems, [Model](const int32 ItemIndex) { return Model->CachedStoreItems[ItemIndex].Cost; });
+		if (AvailableItems.Num() < 2
+			|| Model->CachedStoreItems[AvailableItems[0]].Cost + Model->CachedStoreItems[AvailableItems[1]].Cost > StartCurrency)
+		{
+			UE_LOG(LogMolecularUI, Error, TEXT("[%hs] Needs two available items the player can afford."), __FUNCTION__);
+			return;
+		}
+		const FStoreItem FirstItem = Model->CachedStoreItems[AvailableItems[0]];
+		const FStoreItem SecondItem = Model->CachedStoreItems[AvailableItems[1]];
+		const int32 NumOwnedItems = Model->CachedOwnedItems.Num();
+
+		auto IsOwned = [Model](const FStoreItem& Item)
+		{
+			return Model->CachedOwnedItems.ContainsByPredicate([&Item](const FStoreItem& OwnedItem) { return OwnedItem.Handle == Item.Handle; });
+		};
+		auto IsInStore = [Model](const FStoreItem& Item) { return Model->CatalogIndex->FindItemIndex(Item.Handle) != INDEX_NONE; };
+		auto MakeRequest = [](const FStoreItem& Item)
+		{
+			FTransactionRequest Request;
+			Request.ItemIds.Add(Item.ItemId);
+			return Request;
+		};
+
+		// The first purchase holds the purchasing state until its answer comes, as LazyPurchaseItem does.
+		StoreVM->AddStoreState(MolecularUITags::Store::State::Purchasing);
+		const uint32 FirstTransactionId = Model->ProjectTransaction(MakeRequest(FirstItem), /*bPurchase*/ true);
+		const bool bSecondAllowed = Model->CanStartTransaction();
+		const uint32 SecondTransactionId = Model->ProjectTransaction(MakeRequest(SecondItem), /*bPurchase*/ true);
+		const bool bBothProjected = FirstTransactionId != 0 && SecondTransactionId != 0
+			&& IsOwned(FirstItem) && IsOwned(SecondItem) && !IsInStore(FirstItem) && !IsInStore(SecondItem)
+			&& StoreVM->GetPlayerCurrency() == StartCurrency - FirstItem.Cost - SecondItem.Cost;
+
+		Model->RollbackTransaction(SecondTransactionId);
+		const bool bSecondRolledBack = IsOwned(FirstItem) && !IsInStore(FirstItem) && !IsOwned(SecondItem) && IsInStore(SecondItem)
+			&& StoreVM->GetPlayerCurrency() == StartCurrency - FirstItem.Cost;
+
+		Model->RollbackTransaction(FirstTransactionId);
+		StoreVM->RemoveStoreState(MolecularUITags::Store::State::Purchasing);
+		const bool bRestored = !IsOwned(FirstItem) && IsInStore(FirstItem) && Model->CachedOwnedItems.Num() == NumOwnedItems
+			&& StoreVM->GetPlayerCurrency() == StartCurrency && StoreVM->HasStoreState(MolecularUITags::Store::State::Ready);
+
+		const bool bPassed = ensureMsgf(bSecondAllowed, TEXT("A purchase should be allowed while another is in flight"))
+			&& ensureMsgf(bBothProjected, TEXT("Both purchases should be projected, with their costs taken"))
+			&& ensureMsgf(bSecondRolledBack, TEXT("Rolling back the second purchase should leave the first one bought"))
+			&& ensureMsgf(bRestored, TEXT("Rolling back both purchases should restore the lists, currency and state"));
+		Report(__FUNCTION__, bPassed);
+	}
+};
+
+/**
+ * Development-only regression checks of the data provider chain against the mock backend, run from the console.
+ * Each one ensures on the first expectation it finds broken and logs its outcome to LogMolecularUI.
+ */
+struct FStoreProviderChecks
+{
+	struct FOverlapState
+	{
+		TStrongObjectPtr<UStoreDataProviderMultiplexer> Multiplexer;
+		bool bFirstLoadDone = false;
+		bool bRestartedLoadDone = false;
+		int32 NumChangesAnswered = 0;
+	};
+
+	// Small pages, so the first load is still running when the restart comes in.
+	static constexpr int32 OverlapPageSize = 4;
+
+	/**
+	 * Starts a paged load through a multiplexer in front of the mock provider, then restarts it and asks for changes
+	 * from two versions while its second page is in flight, as a refresh during a load does. Every request has to be
+	 * answered, with a page or a failure, before the timeout. Optional args: timeout in seconds, default 10.
+	 */
+	static void RunOverlappingPageLoad(const TArray<FString>& Args, UWorld* World)
+	{
+		UGameInstance* GameInstance = World != nullptr ? World->GetGameInstance() : nullptr;
+		UMockStoreDataProviderSubsystem* MockProvider = GameInstance != nullptr ? GameInstance->GetSubsystem<UMockStoreDataProviderSubsystem>() : nullptr;
+		if (MockProvider == nullptr)
+		{
+			UE_LOG(LogMolecularUI, Error, TEXT("[%hs] Needs a running game with the mock store data provider."), __FUNCTION__);
+			return;
+		}
+		const float TimeoutSeconds = Args.IsEmpty() ? 10.0f : FMath::Max(0.1f, FCString::Atof(*Args[0]));
+
+		TScriptInterface<IStoreDataProvider> InnerProvider;
+		InnerProvider.SetObject(MockProvider);
+		InnerProvider.SetInterface(Cast<IStoreDataProvider>(MockProvider));
+
+		const TSharedRef<FOverlapState> State = MakeShared<FOverlapState>();
+		State->Multiplexer = TStrongObjectPtr<UStoreDataProviderMultiplexer>(NewObject<UStoreDataProviderMultiplexer>(GetTransientPackage()));
+		State->Multiplexer->SetInnerProvider(InnerProvider);
+
+		// Each request holds the chain that sends the next page, as the model's paged load does.
+		auto StartLoad = [State](bool FOverlapState::* bDone, TFunction<void()> OnSecondPageSent)
+		{
+			TSharedRef<TFunction<void(const FString&)>> FetchPage = MakeShared<TFunction<void(const FString&)>>();
+			*FetchPage = [State, bDone, OnSecondPageSent, WeakFetchPage = TWeakPtr<TFunction<void(const FString&)>>(FetchPage)](const FString& Cursor)
+			{
+				TSharedPtr<TFunction<void(const FString&)>> FetchNextPage = WeakFetchPage.Pin();
+				State->Multiplexer->FetchStoreItemsPage(Cursor, OverlapPageSize,
+					[State, bDone, OnSecondPageSent, FetchNextPage, bFirstPage = Cursor.IsEmpty()](FStoreItemPage&& Page, const FText&)
+					{
+						if (Page.IsLastPage())
+						{
+							(*State).*bDone = true;
+							return;
+						}
+						(*FetchNextPage)(Page.NextCursor);
+						if (bFirstPage && OnSecondPageSent)
+						{
+							OnSecondPageSent();
+						}
+					},
+					[State, bDone](const FText&)
+					{
+						(*State).*bDone = true;
+					});
+			};
+			(*FetchPage)(FString());
+		};
+
+		StartLoad(&FOverlapState::bFirstLoadDone, [State, StartLoad]()
+		{
+			StartLoad(&FOverlapState::bRestartedLoadDone, nullptr);
+			for (const int64 SinceVersion : { int64(0), int64(-1) })
+			{
+				State->Multiplexer->FetchStoreChanges(SinceVersion,
+					[State](FStoreChangeSet&&, const FText&) { ++State->NumChangesAnswered; },
+					[State](const FText&) { ++State->NumChangesAnswered; });
+			}
+		});
+
+		FTimerHandle TimeoutHandle;
+		World->GetTimerManager().SetTimer(TimeoutHandle, FTimerDelegate::CreateLambda([State]()
+		{
+			const int32 NumReadsInFlight = State->Multiplexer->GetNumReadsInFlight();
+			const bool bPassed = ensureMsgf(State->bFirstLoadDone, TEXT("The paged load restarted under it never finished"))
+				&& ensureMsgf(State->bRestartedLoadDone, TEXT("The restarted paged load never finished"))
+				&& ensureMsgf(State->NumChangesAnswered == 2, TEXT("%d of 2 overlapping change queries answered"), State->NumChangesAnswered)
+				&& ensureMsgf(NumReadsInFlight == 0, TEXT("%d reads still in flight"), NumReadsInFlight);
+			FStoreModelChecks::Report("FStoreProviderChecks::RunOverlappingPageLoad", bPassed);
+		}), TimeoutSeconds, false);
+	}
+};
+
+static FAutoConsoleCommand CmdCheckSortToNone(
+	TEXT("MolecularUI.Check.SortToNone"),
+	TEXT("Checks that clearing the sort mode restores catalog order, including when the previous matches are refined."),
+	FConsoleCommandDelegate::CreateStatic(&FStoreModelChecks::RunSortToNone));
+
+static FAutoConsoleCommand CmdCheckPatchedIndex(
+	TEXT("MolecularUI.Check.PatchedIndex"),
+	TEXT("Checks that a change set patched into the catalog index matches and sorts like an index built from the changed catalog."),
+	FConsoleCommandDelegate::CreateStatic(&FStoreModelChecks::RunPatchedIndex));
+
+static FAutoConsoleCommand CmdCheckBackToBackPurchases(
+	TEXT("MolecularUI.Check.BackToBackPurchases"),
+	TEXT("Projects two purchases on the live store model, the second while the first is in flight, rolls them back one at a time and checks the lists and currency after each."),
+	FConsoleCommandWithWorldDelegate::CreateStatic(&FStoreModelChecks::RunBackToBackPurchases));
+
+static FAutoConsoleCommand CmdCheckOverlappingPageLoad(
+	TEXT("MolecularUI.Check.OverlappingPageLoad"),
+	TEXT("Restarts a paged load from the mock provider while a page is in flight and checks every request is answered. Optional args: timeout in seconds, default 10."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&FStoreProviderChecks::RunOverlappingPageLoad));
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,80 @@
+// Copyright Mike Desrosiers, All Rights Reserved.
+
+#include "ViewModels/StoreViewModel.h"
+
+#include "Utils/MolecularCollectionDiff.h"
+#include "ViewModels/ItemViewModel.h"
+
+void UStoreViewModel::SetAvailableItems(const TArray<TObjectPtr<UItemViewModel>>& InItems)
+{
+	if (UpdateItemList(AvailableItems, InItems, AvailableItemsChanges))
+	{
+		UE_MVVM_BROADCAST_FIELD_VALUE_CHANGED(AvailableItems);
+		UE_MVVM_BROADCAST_FIELD_VALUE_CHANGED(AvailableItemsChanges);
+		OnAvailableItemsChanged.Broadcast(AvailableItemsChanges);
+	}
+}
+
+void UStoreViewModel::SetOwnedItems(const TArray<TObjectPtr<UItemViewModel>>& InItems)
+{
+	if (UpdateItemList(OwnedItems, InItems, OwnedItemsChanges))
+	{
+		UE_MVVM_BROADCAST_FIELD_VALUE_CHANGED(OwnedItems);
+		UE_MVVM_BROADCAST_FIELD_VALUE_CHANGED(OwnedItemsChanges);
+		OnOwnedItemsChanged.Broadcast(OwnedItemsChanges);
+	}
+}
+
+void UStoreViewModel::AddCategories_AvailableItems(TConstArrayView<UCategoryViewModel*> InCategories)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	TSet<FGameplayTag> KnownTags;
+	KnownTags.Reserve(CategoryTabs_AvailableItems.Num() + InCategories.Num());
+	for (const UCategoryViewModel* Category : CategoryTabs_AvailableItems)
+	{
+		if (IsValid(Category))
+		{
+			KnownTags.Add(Category->GetCategoryTag());
+		}
+	}
+
+	const int32 PreviousNum = CategoryTabs_AvailableItems.Num();
+	for (UCategoryViewModel* Category : InCategories)
+	{
+		bool bAlreadyKnown = false;
+		if (IsValid(Category))
+		{
+			KnownTags.Add(Category->GetCategoryTag(), &bAlreadyKnown);
+			if (!bAlreadyKnown)
+			{
+				CategoryTabs_AvailableItems.Add(Category);
+			}
+		}
+	}
+
+	if (CategoryTabs_AvailableItems.Num() != PreviousNum)
+	{
+		UE_MVVM_BROADCAST_FIELD_VALUE_CHANGED(CategoryTabs_AvailableItems);
+	}
+}
+
+bool UStoreViewModel::UpdateItemList(TArray<TObjectPtr<UItemViewModel>>& Items, const TArray<TObjectPtr<UItemViewModel>>& InItems, FMolecularCollectionChangeSet& OutChangeSet)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
+
+	// Past a quarter of the list, rebuilding the rows is cheaper than replaying the edits. The diff finds out before
+	// it builds any move.
+	const int32 MaxChanges = FMath::Max(16, InItems.Num() / 4);
+
+	TArray<FMolecularCollectionChange> Changes;
+	if (!MolecularUI::CollectionDiff::Compute(Items, InItems, MaxChanges, Changes))
+	{
+		return false;
+	}
+
+	Items = InItems;
+	OutChangeSet.Changes = MoveTemp(Changes);
+	++OutChangeSet.Revision;
+	return true;
+}
@@ -0,0 +1,30 @@
+// Copyright Mike Desrosiers, All Rights Reserved.
+
+#include "ViewModels/WindowedCollectionViewModel.h"
+
+void UWindowedCollectionViewModel::SetWindow(const int32 InStartIndex, const TArray<TObjectPtr<UMVVMViewModelBase>>& InItems)
+{
+	UE_MVVM_SET_PROPERTY_VALUE(WindowStartIndex, InStartIndex);
+	UE_MVVM_SET_PROPERTY_VALUE(WindowItems, InItems);
+}
+
+UMVVMViewModelBase* UWindowedCollectionViewModel::GetItemAt(const int32 Index) const
+{
+	const int32 WindowIndex = Index - WindowStartIndex;
+	return WindowItems.IsValidIndex(WindowIndex) ? WindowItems[WindowIndex].Get() : nullptr;
+}
+
+void UWindowedCollectionViewModel::GetRequestedWindow(int32& OutStart, int32& OutEnd) const
+{
+	const int32 FirstVisible = FMath::Clamp(VisibleRange.FirstIndex, 0, TotalCount);
+	const int32 EndVisible = FMath::Clamp(VisibleRange.FirstIndex + FMath::Max(VisibleRange.Num, 0), FirstVisible, TotalCount);
+	OutStart = FMath::Max(FirstVisible - PrefetchMargin, 0);
+	OutEnd = FMath::Min(EndVisible + PrefetchMargin, TotalCount);
+}
+
+bool UWindowedCollectionViewModel::IsVisibleRangeLoaded() const
+{
+	const int32 FirstVisible = FMath::Clamp(VisibleRange.FirstIndex, 0, TotalCount);
+	const int32 EndVisible = FMath::Clamp(VisibleRange.FirstIndex + FMath::Max(VisibleRange.Num, 0), FirstVisible, TotalCount);
+	return FirstVisible >= WindowStartIndex && EndVisible <= WindowStartIndex + WindowItems.Num();
+}
@@ -16,9 +16,15 @@ class UMockStoreDataProviderSubsystem : public UGameInstanceSubsystem, public IS
 
 public:
 	// Begin IStoreDataProvider implementation
-	virtual void FetchStoreItems(TFunction<void(const TArray<FStoreItem>&, const FText&)> OnSuccess,
+	virtual void FetchStoreItems(TFunction<void(const TSharedRef<const FStoreCatalogSnapshot>&, const FText&)> OnSuccess,
 								 TFunction<void(const FText&)> OnFailure) override;
-	virtual void FetchOwnedItems(TFunction<void(const TArray<FStoreItem>&, const FText&)> OnSuccess,
+	virtual void FetchStoreItemsPage(const FString& Cursor, const int32 PageSize,
+									 TFunction<void(FStoreItemPage&&, const FText&)> OnPage,
+									 TFunction<void(const FText&)> OnFailure) override;
+	virtual void FetchStoreChanges(const int64 SinceVersion,
+								   TFunction<void(FStoreChangeSet&&, const FText&)> OnSuccess,
+								   TFunction<void(const FText&)> OnFailure) override;
+	virtual void FetchOwnedItems(TFunction<void(const TSharedRef<const FStoreCatalogSnapshot>&, const FText&)> OnSuccess,
 								 TFunction<void(const FText&)> OnFailure) override;
 	virtual void FetchPlayerCurrency(TFunction<void(int32, const FText&)> OnSuccess,
 									 TFunction<void(const FText&)> OnFailure) override;
@@ -35,6 +41,9 @@ protected:
 	void CreateDummyOwnedStoreData(TFunction<void()> OnComplete);
 	void CreateDummyPlayerCurrency();
 
+	// Logs a completed transaction's items as changed in both lists, along with the currency, under a new version.
+	void RecordTransaction(const FTransactionRequest& Request);
+
 
 	/**
 	 * Asynchronously loads items from a given data table into the target array, optionally marking them as owned.
@@ -50,14 +59,40 @@ protected:
 
 	TArray<FStoreItem> BackendStoreItems;
 	TArray<FStoreItem> BackendOwnedStoreItems;
+
+	// The backend lists as last handed out. Reset whenever a list changes, so fetches in between share one snapshot.
+	TSharedPtr<const FStoreCatalogSnapshot> StoreItemsSnapshot;
+	TSharedPtr<const FStoreCatalogSnapshot> OwnedItemsSnapshot;
+
+	// Returns the cached snapshot of a backend list, copying the list into a new one only if it changed since.
+	TSharedRef<const FStoreCatalogSnapshot> GetSnapshot(TSharedPtr<const FStoreCatalogSnapshot>& Snapshot, const TArray<FStoreItem>& Items) const;
 	int32 BackendPlayerCurrency = INDEX_NONE;
 
-	FTimerHandle ItemLoadHandle;
-	FTimerHandle OwnedItemLoadHandle;
-	FTimerHandle CurrencyLoadHandle;
-	FTimerHandle TransactionHandle;
-	FTimerHandle SellHandle;
-	
+	enum class EMockChangeList : uint8
+	{
+		Store,
+		Owned,
+		Currency
+	};
+
+	// What changed at a version. The backend state at fetch time says how, so entries hold no item data.
+	struct FMockChange
+	{
+		int64 Version = 0;
+		EMockChangeList List = EMockChangeList::Store;
+		FName ItemId;
+	};
+
+	// Version of the backend state, bumped by every transaction.
+	int64 BackendVersion = 0;
+
+	// Changes in ascending version order. Oldest entries are dropped past MaxChangeLogEntries.
+	TArray<FMockChange> ChangeLog;
+	static constexpr int32 MaxChangeLogEntries = 1024;
+
+	// Newest version dropped from the log. Callers older than this have to fetch everything again.
+	int64 OldestLoggedVersion = 0;
+
 	bool bDummyStoreDataInitialized = false;
 	bool bDummyOwnedDataInitialized = false;
 	bool bDummyPlayerCurrencyInitialized = false;
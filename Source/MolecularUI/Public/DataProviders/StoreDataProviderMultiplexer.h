@@ -0,0 +1,108 @@
+// Copyright Mike Desrosiers, All Rights Reserved.
+
+#pragma once
+
+#include <UObject/Object.h>
+
+#include "Interfaces/IStoreDataProvider.h"
+#include "StoreDataProviderMultiplexer.generated.h"
+
+/**
+ * Sits in front of another store data provider and shares its requests.
+ *
+ * Reads of the same resource issued while one is already in flight join it instead of starting another, and every
+ * caller gets the result. Reads that differ, like pages at other cursors or changes since another version, are sent
+ * on as they come, so the inner provider must answer every request even when several overlap. A request it drops
+ * leaves its entry here, and every later caller of the same read would join it and wait forever. Transactions change
+ * state, so they are never merged. They are queued and sent one at a time instead.
+ */
+UCLASS()
+class UStoreDataProviderMultiplexer : public UObject, public IStoreDataProvider
+{
+	GENERATED_BODY()
+
+public:
+	void SetInnerProvider(const TScriptInterface<IStoreDataProvider>& InInnerProvider) { InnerProvider = InInnerProvider; }
+	const TScriptInterface<IStoreDataProvider>& GetInnerProvider() const { return InnerProvider; }
+
+	// Begin IStoreDataProvider implementation
+	virtual void FetchStoreItems(TFunction<void(const TSharedRef<const FStoreCatalogSnapshot>&, const FText&)> OnSuccess,
+								 TFunction<void(const FText&)> OnFailure) override;
+	virtual void FetchStoreItemsPage(const FString& Cursor, const int32 PageSize,
+									 TFunction<void(FStoreItemPage&&, const FText&)> OnPage,
+									 TFunction<void(const FText&)> OnFailure) override;
+	virtual void FetchStoreChanges(const int64 SinceVersion,
+								   TFunction<void(FStoreChangeSet&&, const FText&)> OnSuccess,
+								   TFunction<void(const FText&)> OnFailure) override;
+	virtual void FetchOwnedItems(TFunction<void(const TSharedRef<const FStoreCatalogSnapshot>&, const FText&)> OnSuccess,
+								 TFunction<void(const FText&)> OnFailure) override;
+	virtual void FetchPlayerCurrency(TFunction<void(int32, const FText&)> OnSuccess,
+									 TFunction<void(const FText&)> OnFailure) override;
+	virtual void PurchaseItem(const FTransactionRequest& Request,
+							  TFunction<void(const FText&)> OnSuccess,
+							  TFunction<void(const FText&)> OnFailure) override;
+	virtual void SellItem(const FTransactionRequest& Request,
+							  TFunction<void(const FText&)> OnSuccess,
+							  TFunction<void(const FText&)> OnFailure) override;
+	virtual int32 GetSellRefund(const FStoreItem& Item) const override;
+	// End IStoreDataProvider implementation
+
+	/** Number of callers that joined a request already in flight instead of starting their own, since creation. */
+	int32 GetNumCoalescedRequests() const { return NumCoalescedRequests; }
+
+	/** Number of distinct reads sent to the inner provider that haven't been answered yet. */
+	int32 GetNumReadsInFlight() const { return ItemListRequests.Num() + PageRequests.Num() + ChangeRequests.Num() + CurrencyRequests.Num(); }
+
+private:
+	// Callers waiting on one in-flight request, in the order they asked.
+	template<typename... ResultTypes>
+	struct TSubscribers
+	{
+		TArray<TFunction<void(ResultTypes...)>> OnSuccess;
+		TArray<TFunction<void(const FText&)>> OnFailure;
+	};
+
+	using FItemListSubscribers = TSubscribers<const TSharedRef<const FStoreCatalogSnapshot>&, const FText&>;
+	using FPageSubscribers = TSubscribers<FStoreItemPage&&, const FText&>;
+	using FChangeSubscribers = TSubscribers<FStoreChangeSet&&, const FText&>;
+	using FCurrencySubscribers = TSubscribers<int32, const FText&>;
+
+	/**
+	 * Adds a caller to the request in flight for Key, or starts tracking a new one.
+	 * @return The subscribers of a new request the caller has to send, or null if it joined one in flight.
+	 */
+	template<typename KeyType, typename... ResultTypes>
+	TSharedPtr<TSubscribers<ResultTypes...>> Subscribe(TMap<KeyType, TSharedRef<TSubscribers<ResultTypes...>>>& InFlight, const KeyType& Key,
+		TFunction<void(ResultTypes...)>&& OnSuccess, TFunction<void(const FText&)>&& OnFailure);
+
+	// Sends the transaction at the head of the queue, if none is in flight.
+	void SendNextTransaction();
+
+	struct FQueuedTransaction
+	{
+		FTransactionRequest Request;
+		bool bPurchase = true;
+		TFunction<void(const FText&)> OnSuccess;
+		TFunction<void(const FText&)> OnFailure;
+	};
+
+	UPROPERTY(Transient)
+	TScriptInterface<IStoreDataProvider> InnerProvider;
+
+	// Keyed by the list they fetch.
+	TMap<FName, TSharedRef<FItemListSubscribers>> ItemListRequests;
+
+	// Keyed by cursor and page size.
+	TMap<FString, TSharedRef<FPageSubscribers>> PageRequests;
+
+	// Keyed by the version the changes are fetched since.
+	TMap<int64, TSharedRef<FChangeSubscribers>> ChangeRequests;
+
+	// There is only one currency, keyed by NAME_None.
+	TMap<FName, TSharedRef<FCurrencySubscribers>> CurrencyRequests;
+
+	TArray<FQueuedTransaction> TransactionQueue;
+	bool bTransactionInFlight = false;
+
+	int32 NumCoalescedRequests = 0;
+};
@@ -19,10 +19,55 @@ class IStoreDataProvider
 	GENERATED_BODY()
 
 public:
-	virtual void FetchStoreItems(TFunction<void(const TArray<FStoreItem>&, const FText&)> OnSuccess,
+	/**
+	 * Fetches the whole catalog. The snapshot is immutable and may be shared with other callers, so receivers that
+	 * need to change the rows copy them, and receivers that already hold the same snapshot can skip it.
+	 */
+	virtual void FetchStoreItems(TFunction<void(const TSharedRef<const FStoreCatalogSnapshot>&, const FText&)> OnSuccess,
 								 TFunction<void(const FText&)> OnFailure) = 0;
 
-	virtual void FetchOwnedItems(TFunction<void(const TArray<FStoreItem>&, const FText&)> OnSuccess,
+	/**
+	 * Fetches the catalog one page at a time, so callers can show items before the whole catalog has arrived.
+	 * Start with an empty cursor, then pass each page's NextCursor until a page comes back with an empty one.
+	 * Pages are moved to the caller, so no copy of them outlives the callback on the provider's side.
+	 *
+	 * The default implementation delivers all of FetchStoreItems as a single page.
+	 *
+	 * @param Cursor The NextCursor of the previous page, or empty for the first page.
+	 * @param PageSize Preferred number of items per page. Providers may return fewer.
+	 */
+	virtual void FetchStoreItemsPage(const FString& Cursor, const int32 PageSize,
+									 TFunction<void(FStoreItemPage&&, const FText&)> OnPage,
+									 TFunction<void(const FText&)> OnFailure)
+	{
+		FetchStoreItems([OnPage = MoveTemp(OnPage)](const TSharedRef<const FStoreCatalogSnapshot>& Snapshot, const FText& Status)
+		{
+			FStoreItemPage Page;
+			Page.Items = Snapshot->Items;
+			Page.Version = Snapshot->Version;
+			OnPage(MoveTemp(Page), Status);
+		}, MoveTemp(OnFailure));
+	}
+
+	/**
+	 * Fetches what changed since a version the caller is up to date with, instead of every list in full.
+	 * Versions come from FStoreItemPage::Version and from previous change sets. Applying a change set twice, or one
+	 * that overlaps data fetched in full, is harmless: upserts carry the current data and removals of absent items are no-ops.
+	 *
+	 * The default implementation keeps no history, and asks for a full refresh.
+	 */
+	virtual void FetchStoreChanges(const int64 SinceVersion,
+								   TFunction<void(FStoreChangeSet&&, const FText&)> OnSuccess,
+								   TFunction<void(const FText&)> OnFailure)
+	{
+		FStoreChangeSet Changes;
+		Changes.Version = SinceVersion;
+		Changes.bRequiresFullRefresh = true;
+		OnSuccess(MoveTemp(Changes), FText::GetEmpty());
+	}
+
+	/** Fetches the player's owned items, shared the same way as FetchStoreItems. */
+	virtual void FetchOwnedItems(TFunction<void(const TSharedRef<const FStoreCatalogSnapshot>&, const FText&)> OnSuccess,
 								 TFunction<void(const FText&)> OnFailure) = 0;
 
 	virtual void FetchPlayerCurrency(TFunction<void(int32, const FText&)> OnSuccess,
@@ -35,4 +80,15 @@ public:
 	virtual void SellItem(const FTransactionRequest& Request,
 							  TFunction<void(const FText&)> OnSuccess,
 							  TFunction<void(const FText&)> OnFailure) = 0;
+
+	/**
+	 * Currency that selling the item refunds. Callers show it before SellItem answers, so it has to agree with the
+	 * refund SellItem grants.
+	 *
+	 * The default implementation refunds half the cost, rounded down.
+	 */
+	virtual int32 GetSellRefund(const FStoreItem& Item) const
+	{
+		return Item.Cost / 2;
+	}
 };
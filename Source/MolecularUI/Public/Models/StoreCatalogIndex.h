@@ -0,0 +1,583 @@
+// Copyright Mike Desrosiers, All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+#include <String/Find.h>
+
+#include "MolecularTypes.h"
+#include "Utils/MolecularBitmap.h"
+
+/**
+ * Trigram inverted index over store item display names.
+ *
+ * Display names are normalized once when the catalog is loaded (see FoldText) and stored back to back in a single
+ * buffer, then split into overlapping 3-character grams. A query is answered by intersecting the posting lists of its
+ * own grams, so the cost scales with the number of candidates instead of the size of the catalog. Candidates are
+ * verified against their key afterward, since sharing every gram with the query does not guarantee a contiguous match.
+ */
+class MOLECULARUI_API FStoreTextIndex
+{
+public:
+	/** Rebuilds the index. Item indices returned by queries refer to positions in Items. */
+	void Build(const TArray<FStoreItem>& Items);
+
+	/** Indexes the entries of Items past the ones already indexed. Items must start with the previously indexed entries. */
+	void Append(const TArray<FStoreItem>& Items);
+
+	/**
+	 * Re-indexes one item whose entry was replaced. A new key is added next to the old one, and its grams are added
+	 * to the posting lists. The old grams keep listing the item, which only costs a failed ItemMatches until the next Build.
+	 * @return True if the item's key changed.
+	 */
+	bool Update(const int32 ItemIndex, const FStoreItem& Item);
+
+	void Reset();
+
+	/**
+	 * Normalizes text for matching: lower-cased with the active culture's rules, then stripped of Latin diacritics,
+	 * so "Épée", "EPEE" and "epee" all share a key. Queries must be folded before they are passed in.
+	 */
+	static FString FoldText(const FString& Text);
+
+	/**
+	 * Finds every item whose display name contains the query, ignoring case and diacritics.
+	 *
+	 * @param FoldedQuery The filter text, already passed through FoldText.
+	 * @param OutItemIndices Receives the matching item indices in ascending order.
+	 */
+	void FindMatches(const FString& FoldedQuery, TArray<int32>& OutItemIndices) const;
+
+	/**
+	 * Collects a superset of the items matching the query from the posting lists alone.
+	 * Callers must confirm each candidate with ItemMatches, which lets that check be spread across threads.
+	 */
+	void GatherCandidates(const FString& FoldedQuery, TArray<int32>& OutItemIndices) const;
+
+	/** Tests a single item against a folded query without touching the posting lists. Doesn't allocate. */
+	bool ItemMatches(const int32 ItemIndex, const FString& FoldedQuery) const
+	{
+		return KeyOffsets.IsValidIndex(ItemIndex) && UE::String::FindFirst(GetKey(ItemIndex), FoldedQuery, ESearchCase::CaseSensitive) != INDEX_NONE;
+	}
+
+	/** The folded display name of an item, as a view into the key buffer. */
+	FStringView GetKey(const int32 ItemIndex) const
+	{
+		return FStringView(KeyBuffer.GetData() + KeyOffsets[ItemIndex], KeyLengths[ItemIndex]);
+	}
+
+	int32 Num() const { return KeyOffsets.Num(); }
+
+private:
+	using FTrigram = uint64;
+
+	static FTrigram MakeTrigram(const TCHAR A, const TCHAR B, const TCHAR C)
+	{
+		// 21 bits per character covers the full code point range regardless of the platform's TCHAR width.
+		constexpr uint64 CharMask = 0x1FFFFF;
+		return ((static_cast<uint64>(A) & CharMask) << 42) | ((static_cast<uint64>(B) & CharMask) << 21) | (static_cast<uint64>(C) & CharMask);
+	}
+
+	// Keeps only the entries of InOut that are also present in Other. Both arrays must be sorted.
+	static void IntersectSorted(TArray<int32>& InOut, const TArray<int32>& Other);
+
+	// Adds an item to the posting list of every gram of its key.
+	void AddPostings(const int32 ItemIndex, const FStringView Key);
+
+	// Every item's folded display name, back to back. Keys replaced by Update stay behind until the next Build.
+	TArray<TCHAR> KeyBuffer;
+
+	// Start and length of each item's current key in KeyBuffer.
+	TArray<int32> KeyOffsets;
+	TArray<int32> KeyLengths;
+
+	// Sorted item indices for every trigram that appears in at least one display name.
+	TMap<FTrigram, TArray<int32>> Postings;
+};
+
+/**
+ * Typo-tolerant, ranked matching of store item display names.
+ *
+ * Folded names are packed into one contiguous buffer of 16-bit code units so the scoring kernel scans them with SIMD
+ * compares instead of walking FStrings. The kernel uses AVX2 when the build targets it, SSE2 on other x64 builds and
+ * NEON on ARM. There is no runtime dispatch: most names fit in one or two 8-unit vectors, so AVX2 only pays off for
+ * long names and isn't worth an indirect call per character. Each name also keeps a 64-bit mask of the characters it
+ * contains, which rejects most candidates before any scan when the query has letters the name lacks.
+ */
+class MOLECULARUI_API FStoreFuzzyIndex
+{
+public:
+	/** Packs the keys of an already built text index. */
+	void Build(const FStoreTextIndex& TextIndex);
+
+	/** Packs the keys the text index gained since the last Build or Append. */
+	void Append(const FStoreTextIndex& TextIndex);
+
+	/** Packs the new key of an item the text index re-indexed. The old name stays packed until the next Build. */
+	void Update(const int32 ItemIndex, const FStoreTextIndex& TextIndex);
+	void Reset();
+
+	int32 Num() const { return NameOffsets.Num(); }
+
+	/** A folded query, converted once for scoring against many names. */
+	struct FQuery
+	{
+		TArray<uint16, TInlineAllocator<64>> Chars;
+		uint64 CharMask = 0;
+		int32 MaxTypos = 0;
+	};
+
+	/** Prepares the filter text, already passed through FStoreTextIndex::FoldText, for Score. */
+	static FQuery PrepareQuery(const FString& FoldedQuery);
+
+	/**
+	 * Scores the candidates against the query and keeps the best ones.
+	 *
+	 * @param FoldedQuery The filter text, already passed through FStoreTextIndex::FoldText.
+	 * @param Candidates The item indices to score.
+	 * @param MaxResults How many matches to keep. Zero or less keeps every match.
+	 * @param OutItemIndices Receives the matches, best score first.
+	 */
+	void Rank(const FString& FoldedQuery, const TArray<int32>& Candidates, const int32 MaxResults, TArray<int32>& OutItemIndices) const;
+
+	/**
+	 * Scores one name as a subsequence match of the query.
+	 * Query characters that can't be placed count as typos, and the match fails past the query's MaxTypos of them.
+	 * Names too short for the query, or lacking too many of its characters, are rejected before any scan.
+	 *
+	 * @return False if the item doesn't match.
+	 */
+	bool Score(const int32 ItemIndex, const FQuery& Query, int32& OutScore) const;
+
+	/** Typos tolerated for a query of the given length. Short queries must match exactly. */
+	static int32 GetMaxTypos(const int32 QueryLen) { return QueryLen <= 3 ? 0 : (QueryLen <= 7 ? 1 : 2); }
+
+	/** The instruction set the scan kernel was compiled for. */
+	static const TCHAR* GetKernelName();
+
+private:
+	static uint64 CharBit(const uint16 Char) { return 1ull << (Char & 63); }
+
+	// Appends a name to PackedNames and returns its character mask.
+	uint64 PackName(const FStringView Key);
+
+	// Every folded name back to back, followed by enough padding for a full vector load at the end.
+	TArray<uint16> PackedNames;
+
+	// Start of each item's name in PackedNames, and its length.
+	TArray<int32> NameOffsets;
+	TArray<int32> NameLengths;
+
+	// One bit per character present in each name, see CharBit.
+	TArray<uint64> CharMasks;
+};
+
+/**
+ * Bitmap of item indices for every category tag, built once per catalog load.
+ *
+ * Each item is also added under every parent of its tags, so a lookup matches the same items as
+ * FGameplayTagContainer::HasTag without walking the tag hierarchy per item.
+ */
+class MOLECULARUI_API FStoreCategoryIndex
+{
+public:
+	void Build(const TArray<FStoreItem>& Items);
+
+	/** Adds the entries of Items past the ones already indexed. New tags get the next free ids. */
+	void Append(const TArray<FStoreItem>& Items);
+
+	/** Moves one item whose entry was replaced from the bitmaps of its old tags to those of its new ones. */
+	void Update(const int32 ItemIndex, const FStoreItem& Item);
+	void Reset();
+
+	int32 Num() const { return ItemTagOffsets.Num(); }
+
+	/** Items tagged with CategoryTag or one of its children, or null if there are none. */
+	const FMolecularBitmap* Find(const FGameplayTag& CategoryTag) const { return ItemsByTag.Find(CategoryTag); }
+
+	/** Collects the items that match any of the given tags into OutItems. */
+	void Union(const FGameplayTagContainer& CategoryTags, FMolecularBitmap& OutItems) const;
+
+	/** Dense id of a tag that at least one item rolls up to, or INDEX_NONE. */
+	int32 FindTagId(const FGameplayTag& CategoryTag) const
+	{
+		const int32* TagId = TagIds.Find(CategoryTag);
+		return TagId != nullptr ? *TagId : INDEX_NONE;
+	}
+
+	int32 NumTags() const { return TagIds.Num(); }
+
+	/** The ids of every tag an item rolls up to, each listed once. */
+	TConstArrayView<int32> GetItemTagIds(const int32 ItemIndex) const
+	{
+		return TConstArrayView<int32>(ItemTagIds.GetData() + ItemTagOffsets[ItemIndex], ItemTagCounts[ItemIndex]);
+	}
+
+private:
+	using FRollupCache = TMap<FGameplayTag, FGameplayTagContainer>;
+	using FRollupIds = TArray<int32, TInlineAllocator<16>>;
+
+	// Collects the ids of every tag an item rolls up to, giving tags seen for the first time the next free ids.
+	void CollectRollupIds(const FStoreItem& Item, FRollupCache& RollupsByTag, FRollupIds& OutRollupIds);
+
+	TMap<FGameplayTag, FMolecularBitmap> ItemsByTag;
+
+	// Dense ids for the keys of ItemsByTag, so per-tag tallies can live in flat arrays, and the tag of every id.
+	TMap<FGameplayTag, int32> TagIds;
+	TArray<FGameplayTag> TagsById;
+
+	// Every item's rollup tag ids back to back, and the start and length of each item's run. Runs replaced by Update
+	// stay behind until the next Build.
+	TArray<int32> ItemTagIds;
+	TArray<int32> ItemTagOffsets;
+	TArray<int32> ItemTagCounts;
+};
+
+/**
+ * The fields of every catalog item that filter passes read, one packed array per field, indexed by item index.
+ *
+ * A filter pass touches a few bytes per item here instead of a whole FStoreItem, whose texts, brush and tag container
+ * span hundreds of bytes and several cache lines. Each item's search key lives
+ * in FStoreTextIndex, and the cold presentation data stays in the catalog array the index was built from.
+ */
+class MOLECULARUI_API FStoreCatalogColumns
+{
+public:
+	/** Fills the columns. CategoryIndex must already be built for Items. */
+	void Build(const TArray<FStoreItem>& Items, const FStoreCategoryIndex& CategoryIndex);
+
+	/** Fills the columns for the entries of Items past the ones already filled. CategoryIndex must already cover them. */
+	void Append(const TArray<FStoreItem>& Items, const FStoreCategoryIndex& CategoryIndex);
+
+	/** Refills one item's columns from its replaced entry, and clears its removed bit. CategoryIndex must already be updated for it. */
+	void Update(const int32 ItemIndex, const FStoreItem& Item, const FStoreCategoryIndex& CategoryIndex);
+	void Reset();
+
+	int32 Num() const { return Costs.Num(); }
+
+	bool IsOwned(const int32 ItemIndex) const { return Owned[ItemIndex]; }
+	bool IsRemoved(const int32 ItemIndex) const { return Removed[ItemIndex]; }
+
+	/** True for the items the store lists: neither owned nor removed. */
+	bool IsAvailable(const int32 ItemIndex) const { return !Owned[ItemIndex] && !Removed[ItemIndex]; }
+
+	bool IsCostInRange(const int32 ItemIndex, const int32 MinCost, const int32 MaxCost) const
+	{
+		const int32 Cost = Costs[ItemIndex];
+		return Cost >= MinCost && Cost <= MaxCost;
+	}
+
+	/** True if CategoryMasks hold every tag an item rolls up to, which requires at most 64 distinct tags. */
+	bool HasExactCategoryMasks() const { return bExactCategoryMasks; }
+
+	/** Mask with the bits of the given tags, to test against CategoryMasks. Only meaningful with exact masks. */
+	static uint64 MakeCategoryMask(const FGameplayTagContainer& CategoryTags, const FStoreCategoryIndex& CategoryIndex);
+
+	bool MatchesCategoryMask(const int32 ItemIndex, const uint64 QueryMask) const { return (CategoryMasks[ItemIndex] & QueryMask) != 0; }
+
+	// The model-assigned handle of every item. Items ingested without one keep an invalid handle.
+	TArray<FStoreItemHandle> Handles;
+	TArray<int32> Costs;
+
+	// Name of every item's first category tag, which the category sort orders by. NAME_None for items without one.
+	TArray<FName> PrimaryCategories;
+
+	// One bit per item, set for items the player owns.
+	TBitArray<> Owned;
+
+	// One bit per item, set for items a change set removed. They keep their position until the index is rebuilt.
+	TBitArray<> Removed;
+
+	// One bit per FStoreCategoryIndex tag id an item rolls up to. Tag ids past 63 are not represented.
+	TArray<uint64> CategoryMasks;
+
+private:
+	static uint64 MakeItemCategoryMask(const int32 ItemIndex, const FStoreCategoryIndex& CategoryIndex);
+
+	bool bExactCategoryMasks = true;
+};
+
+/**
+ * Per-category counts of the available items that match a query's text, ignoring its category selection.
+ * Each tab shows how many items selecting it would list.
+ */
+struct FStoreFacetCounts
+{
+	// Indexed by FStoreCategoryIndex tag id. An item counts toward every tag it rolls up to.
+	TArray<int32> CountsByTag;
+
+	// Available items matching the text in any category.
+	int32 Total = 0;
+
+	void Reset(const int32 NumTags)
+	{
+		CountsByTag.Reset();
+		CountsByTag.SetNumZeroed(NumTags);
+		Total = 0;
+	}
+
+	int32 GetCount(const int32 TagId) const { return CountsByTag.IsValidIndex(TagId) ? CountsByTag[TagId] : 0; }
+};
+
+/**
+ * Item indices sorted by cost, built once per catalog load and patched by change sets.
+ *
+ * A cost range query is two binary searches returning a slice of the sorted items, which the filter pass then
+ * intersects with its text and category results.
+ */
+class MOLECULARUI_API FStoreCostIndex
+{
+public:
+	/** Sorts the cost column of FStoreCatalogColumns. */
+	void Build(TConstArrayView<int32> CostsByItem);
+
+	/** Moves the given items to their place for their current cost, inserting the ones not sorted yet. */
+	void Update(TConstArrayView<int32> ItemIndices, TConstArrayView<int32> CostsByItem);
+	void Reset();
+
+	/** The items costing between MinCost and MaxCost inclusive, in ascending cost order. */
+	TConstArrayView<int32> FindRange(const int32 MinCost, const int32 MaxCost) const;
+
+	/** Every item index, in ascending cost order. Ties keep catalog order. */
+	const TArray<int32>& GetItemsByCost() const { return ItemsByCost; }
+
+private:
+	TArray<int32> ItemsByCost;
+
+	// Cost of every entry of ItemsByCost, kept alongside so the binary searches stay in one array.
+	TArray<int32> SortedCosts;
+};
+
+/**
+ * Precomputed orderings of the catalog for every sort field, built once per catalog load and patched by change sets.
+ *
+ * Each item gets its rank in ascending order per field, so any subset of the catalog is sorted by radix sorting its
+ * ranks. Names and category tags are only compared while the ranks are built, never while sorting a filter result.
+ */
+class MOLECULARUI_API FStoreSortIndex
+{
+public:
+	/** Builds the orderings. Columns, TextIndex and CostIndex must already cover the whole catalog. */
+	void Build(const FStoreCatalogColumns& Columns, const FStoreTextIndex& TextIndex, const FStoreCostIndex& CostIndex);
+
+	/**
+	 * Moves the given items to their place in every ordering, inserting the ones not ordered yet, then renumbers the ranks.
+	 * Columns, TextIndex and CostIndex must already be updated for them.
+	 */
+	void Update(TConstArrayView<int32> ItemIndices, const FStoreCatalogColumns& Columns, const FStoreTextIndex& TextIndex, const FStoreCostIndex& CostIndex);
+	void Reset();
+
+	/** Reorders item indices by the given mode. EStoreSortField::None restores catalog order. */
+	void Sort(const FStoreSortMode& SortMode, TArray<int32>& InOutItemIndices) const;
+
+	/**
+	 * Sort without the ranks, comparing the fields of the given items directly. Gives the same order as Sort, including
+	 * its tie-breaks, for catalogs whose orderings aren't built yet. Only meant for small or interim results.
+	 */
+	static void SortUnranked(const FStoreSortMode& SortMode, const FStoreCatalogColumns& Columns, const FStoreTextIndex& TextIndex, TArray<int32>& InOutItemIndices);
+
+private:
+	// Inverts an ordering of item indices into each item's position within it.
+	static void BuildRanks(const TArray<int32>& Order, TArray<uint32>& OutRanks);
+
+	// Three-way comparison of two items in ascending order by Field, with the tie-breaks the ranks use.
+	static int32 CompareUnranked(const EStoreSortField Field, const FStoreCatalogColumns& Columns, const FStoreTextIndex& TextIndex, const int32 A, const int32 B);
+
+	// Position of each item in ascending order, indexed by item index.
+	TArray<uint32> CostRanks;
+	TArray<uint32> NameRanks;
+	TArray<uint32> CategoryRanks;
+
+	// The name and category orderings the ranks were taken from, kept for Update. The cost index holds the cost one.
+	TArray<int32> NameOrder;
+	TArray<int32> CategoryOrder;
+};
+
+/** The inputs of a filter pass, kept so the next pass can tell whether it only narrows this one. */
+struct FStoreFilterQuery
+{
+	// Filter text, passed through FStoreTextIndex::FoldText.
+	FString FoldedText;
+
+	// True when no category restriction applies, either because nothing or "All" is selected.
+	bool bAnyCategory = true;
+
+	// Selected category tabs. An item matches when it has any of these tags or one of their children.
+	FGameplayTagContainer CategoryTags;
+
+	// Inclusive cost bounds. The defaults leave cost unrestricted.
+	int32 MinCost = 0;
+	int32 MaxCost = MAX_int32;
+
+	bool HasCostRange() const { return MinCost > 0 || MaxCost < MAX_int32; }
+
+	// How FoldedText is matched against names.
+	EStoreSearchMode SearchMode = EStoreSearchMode::Substring;
+
+	// Fuzzy searches keep only this many of the best matches. Zero or less keeps all of them.
+	int32 MaxFuzzyResults = 0;
+
+	// Order to return the matches in. Doesn't affect which items match, and fuzzy searches order by score instead.
+	FStoreSortMode SortMode;
+
+	/** True if every item that matches this query is guaranteed to also match Previous. */
+	bool IsNarrowingOf(const FStoreFilterQuery& Previous) const
+	{
+		// Fuzzy results are cut off at MaxFuzzyResults, so a narrower query can still match items the previous one dropped.
+		if (SearchMode != EStoreSearchMode::Substring || Previous.SearchMode != EStoreSearchMode::Substring)
+		{
+			return false;
+		}
+		if (MinCost < Previous.MinCost || MaxCost > Previous.MaxCost)
+		{
+			return false;
+		}
+
+		// Any name containing the new text also contains the old text.
+		if (!FoldedText.Contains(Previous.FoldedText, ESearchCase::CaseSensitive))
+		{
+			return false;
+		}
+		if (Previous.bAnyCategory)
+		{
+			return true;
+		}
+		if (bAnyCategory)
+		{
+			return false;
+		}
+
+		// Deselecting a tab narrows the result, as does swapping a tab for one of its child tags.
+		for (const FGameplayTag& CategoryTag : CategoryTags)
+		{
+			if (!CategoryTag.MatchesAny(Previous.CategoryTags))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/** True if both queries match the same names, whatever their categories and order. */
+	bool HasSameTextAs(const FStoreFilterQuery& Other) const
+	{
+		return SearchMode == Other.SearchMode && FoldedText.Equals(Other.FoldedText, ESearchCase::CaseSensitive);
+	}
+};
+
+/**
+ * The derived lookup structures for one catalog load, indexed by position in the catalog array.
+ *
+ * The model holds it as a shared pointer to const, and async filter passes hold a reference for as long as they read it.
+ * While the model's reference is the only one, the index is extended or patched in place. While a pass still shares it,
+ * the model copies it and changes the copy, so a pass never sees the index change under it.
+ */
+class MOLECULARUI_API FStoreCatalogIndex
+{
+public:
+	/** Indexes a complete catalog, orderings included. */
+	void Build(const TArray<FStoreItem>& Items);
+
+	/**
+	 * Indexes the entries of Items past the ones already indexed, for catalogs that arrive in pages.
+	 * Items must start with the previously indexed entries, so existing item indices stay valid. The text, category and
+	 * column data grow by the new entries only. The cost and sort orderings and the cost histogram span the whole
+	 * catalog, so they are dropped here and left to BuildOrderings once the last page is in. Until then, matching reads
+	 * the columns instead.
+	 */
+	void Append(const TArray<FStoreItem>& Items);
+
+	/** Builds the cost and sort orderings and the cost histogram over every item indexed so far. */
+	void BuildOrderings();
+
+	/**
+	 * Patches the index for a changed catalog instead of rebuilding it. Item indices stay valid: removed items keep
+	 * their position as tombstones no query matches, and new items are appended. Orderings are patched if built.
+	 *
+	 * @param Items The catalog, with the changed entries already replaced and the new ones appended.
+	 * @param ChangedItems Positions below Num() whose entry was replaced under the same handle, including removed items that came back.
+	 * @param RemovedItems Positions below Num() whose item left the catalog.
+	 */
+	void ApplyChanges(const TArray<FStoreItem>& Items, TConstArrayView<int32> ChangedItems, TConstArrayView<int32> RemovedItems);
+
+	/** Tombstones ApplyChanges left since the last Build. */
+	int32 NumRemoved() const { return NumRemovedItems; }
+
+	/** True if the cost and sort orderings and the cost histogram cover the whole catalog. */
+	bool HasOrderings() const { return bHasOrderings; }
+
+	int32 Num() const { return Columns.Num(); }
+
+	/**
+	 * Finds the available (neither owned nor removed) items that match the query.
+	 *
+	 * @param Query The filter to apply.
+	 * @param PreviousMatches When set, only these items are considered. Used to refine a result the query narrows.
+	 * @param OutMatches Receives the matching item indices, ordered by the query's sort mode, or by score for fuzzy searches.
+	 * @param bParallel Whether to spread the per-item checks across worker threads with ParallelFor. Fuzzy searches always run on the calling thread.
+	 * @param OutFacets When set, also receives the facet counts of the query's text, as CountFacets would give. A fuzzy
+	 *                  search scores every available item for them, and keeps its matches in the same pass.
+	 */
+	void Match(const FStoreFilterQuery& Query, const TArray<int32>* PreviousMatches, TArray<int32>& OutMatches, const bool bParallel, FStoreFacetCounts* OutFacets = nullptr) const;
+
+	/** Counts the available items matching the query's text under every category tag, in a single sweep. */
+	void CountFacets(const FStoreFilterQuery& Query, FStoreFacetCounts& OutFacets) const;
+
+	/** True if an item's name matches the query's text, whatever its category or availability. */
+	bool MatchesText(const FStoreFilterQuery& Query, const int32 ItemIndex) const;
+
+	/**
+	 * Adds Delta to the counts of every tag the item rolls up to. The model calls it with MatchesText to take the rows a
+	 * change set or transaction touches out of its counts before the patch, and to put them back after it.
+	 */
+	void AdjustFacets(const int32 ItemIndex, const int32 Delta, FStoreFacetCounts& InOutFacets) const;
+
+	/** Position of an item in the catalog, or INDEX_NONE if it isn't listed. Two array reads, no hashing. */
+	int32 FindItemIndex(const FStoreItemHandle Handle) const
+	{
+		const int32 ItemIndex = FindItemSlot(Handle);
+		return ItemIndex != INDEX_NONE && !Columns.IsRemoved(ItemIndex) ? ItemIndex : INDEX_NONE;
+	}
+
+	/** Like FindItemIndex, but also finds the position a removed item held, which it takes again if it comes back. */
+	int32 FindItemSlot(const FStoreItemHandle Handle) const
+	{
+		const int32 ItemIndex = ItemIndexByHandle.IsValidIndex(Handle.Index) ? ItemIndexByHandle[Handle.Index] : INDEX_NONE;
+		return ItemIndex != INDEX_NONE && Columns.Handles[ItemIndex] == Handle ? ItemIndex : INDEX_NONE;
+	}
+
+	FStoreCatalogColumns Columns;
+	FStoreTextIndex TextIndex;
+	FStoreFuzzyIndex FuzzyIndex;
+	FStoreCategoryIndex CategoryIndex;
+	FStoreCostIndex CostIndex;
+	FStoreSortIndex SortIndex;
+
+	// Costs of the items available for purchase. Empty until the orderings are built.
+	FStoreCostHistogram CostHistogram;
+
+	// Catalog position of every item, indexed by FStoreItemHandle::Index. INDEX_NONE for handles outside this catalog.
+	TArray<int32> ItemIndexByHandle;
+
+private:
+	// Maps the handles of the items from FirstNewItem on.
+	void MapHandles(const int32 FirstNewItem);
+
+	// Buckets the costs of the available items from the cost column. One linear pass, no ordering needed, so change
+	// sets rebuild it rather than patch its bounds.
+	void BuildCostHistogram();
+
+	// Sorts matches with the ranks once they are built, or by comparing their fields before that.
+	void SortMatches(const FStoreSortMode& SortMode, TArray<int32>& InOutMatches) const;
+
+	// Scores the candidates the category, cost and owned filters leave, or every available item when OutFacets is set.
+	void MatchFuzzy(const FStoreFilterQuery& Query, const FMolecularBitmap& CategoryMatches, const uint64 CategoryMask, TArray<int32>& OutMatches, FStoreFacetCounts* OutFacets) const;
+
+	static constexpr int32 NumCostHistogramBuckets = 32;
+
+	bool bHasOrderings = false;
+	int32 NumRemovedItems = 0;
+
+	// Number of candidates each ParallelFor task checks.
+	static constexpr int32 MatchChunkSize = 2048;
+};
@@ -0,0 +1,56 @@
+// Copyright Mike Desrosiers, All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+
+#include "MolecularTypes.h"
+
+/**
+ * Issues FStoreItemHandles for ItemIds and resolves them back.
+ *
+ * Handles are indices into a slot array, so everything keyed by item can live in plain arrays. The ItemId lookup is
+ * only used when items cross the provider boundary. Released slots are reused with a bumped generation.
+ */
+class MOLECULARUI_API FStoreItemRegistry
+{
+public:
+	/** The handle of an ItemId, issuing a new one the first time it is seen. */
+	FStoreItemHandle FindOrAdd(const FName ItemId);
+
+	/** The handle of an ItemId, or an invalid handle if it has none. */
+	FStoreItemHandle Find(const FName ItemId) const;
+
+	/** True if the handle was issued by this registry and its item hasn't been released since. */
+	bool IsValid(const FStoreItemHandle Handle) const
+	{
+		return Slots.IsValidIndex(Handle.Index) && Slots[Handle.Index].Generation == Handle.Generation && !Slots[Handle.Index].ItemId.IsNone();
+	}
+
+	/** The ItemId a handle was issued for, or NAME_None if the handle is stale. */
+	FName GetItemId(const FStoreItemHandle Handle) const { return IsValid(Handle) ? Slots[Handle.Index].ItemId : NAME_None; }
+
+	/** Frees the handle's slot. The handle and any copies of it stop resolving. */
+	void Release(const FStoreItemHandle Handle);
+
+	/** Releases every handle. Slots keep their generations so handles from before never resolve again. */
+	void Reset();
+
+	/** One past the highest slot index ever issued. Arrays indexed by handle need this many entries. */
+	int32 GetMaxIndex() const { return Slots.Num(); }
+
+	int32 Num() const { return IndexById.Num(); }
+
+private:
+	struct FSlot
+	{
+		FName ItemId;
+
+		// Starts at one so a default constructed handle never resolves.
+		uint32 Generation = 1;
+	};
+
+	TArray<FSlot> Slots;
+	TArray<int32> FreeIndices;
+	TMap<FName, int32> IndexById;
+};
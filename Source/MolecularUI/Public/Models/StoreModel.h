@@ -3,8 +3,12 @@
 #pragma once
 
 #include <Subsystems/GameInstanceSubsystem.h>
+#include <atomic>
 
 #include "Interfaces/IStoreDataProvider.h"
+#include "Models/StoreCatalogIndex.h"
+#include "Models/StoreItemRegistry.h"
+#include "Utils/MolecularTokenBucket.h"
 #include "MolecularTypes.h"
 #include "Models/MolecularModelBase.h"
 #include "StoreModel.generated.h"
@@ -16,12 +20,20 @@ class UCategoryViewModel;
 class UMVVMViewModelBase;
 class UItemViewModel;
 class UStoreViewModel;
+class UStoreDataProviderMultiplexer;
+class UWindowedCollectionViewModel;
+struct FStreamableHandle;
 
 UCLASS(DisplayName = "Store Model Base")
 class UStoreModel : public UMolecularModelBase
 {
 	GENERATED_BODY()
 
+	// Drives the ingest paths directly, see MolecularBenchmarks.cpp.
+	friend struct FStoreModelBenchmark;
+	// Drives the transaction projections directly, see MolecularChecks.cpp.
+	friend struct FStoreModelChecks;
+
 public:
 	// Begin UMolecularModelBase overrides.
 	virtual void InitializeModel_Implementation(UWorld* World) override;
@@ -39,6 +51,15 @@ protected:
 	UFUNCTION(BlueprintNativeEvent, Category = "Store Model")
 	void OnFilterTextChanged(UStoreViewModel* InStoreViewModel, FFieldNotificationId Field);
 	
+	UFUNCTION(BlueprintNativeEvent, Category = "Store Model")
+	void OnCostFilterChanged(UStoreViewModel* InStoreViewModel, FFieldNotificationId Field);
+
+	UFUNCTION(BlueprintNativeEvent, Category = "Store Model")
+	void OnSearchModeChanged(UStoreViewModel* InStoreViewModel, FFieldNotificationId Field);
+
+	UFUNCTION(BlueprintNativeEvent, Category = "Store Model")
+	void OnSortModeChanged(UStoreViewModel* InStoreViewModel, FFieldNotificationId Field);
+
 	UFUNCTION(BlueprintNativeEvent, Category = "Store Model")
 	void OnSelectedCategoriesChanged(UStoreViewModel* InStoreViewModel, FFieldNotificationId Field);
 	
@@ -54,6 +75,9 @@ protected:
 	UFUNCTION(BlueprintNativeEvent, Category = "Store Model")
 	void OnItemCategoryInteractionChanged(UCategoryViewModel* InCategoryVM, FFieldNotificationId Field);
 
+	UFUNCTION(BlueprintNativeEvent, Category = "Store Model")
+	void OnItemWindowRangeChanged(UWindowedCollectionViewModel* InWindowVM, FFieldNotificationId Field);
+
 	// Simulates sending and receiving data asynchronously.
 	UFUNCTION(BlueprintNativeEvent, Category = "Store Model")
 	void LazyLoadStoreItems();
@@ -74,15 +98,86 @@ protected:
 	UFUNCTION(BlueprintNativeEvent, Category = "Store Model")
 	void FilterAvailableStoreItems();
 
+	/**
+	 * Schedules FilterAvailableStoreItems for the end of the current world tick.
+	 * Every request made within the same tick collapses into a single pass.
+	 *
+	 * @param bDebounce Wait for MolecularUI.Store.FilterDebounceSeconds without further debounced requests first. Used for typing bursts.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Store Model")
+	void RequestFilterAvailableStoreItems(bool bDebounce = false);
+
 	// Lazy loads the store data from the provider.
 	UFUNCTION(BlueprintNativeEvent, Category = "Store Model")
 	void RefreshStoreData();
 
+	/**
+	 * Rate limited RefreshStoreData, for refreshes the player asks for.
+	 * Past RefreshBurstLimit, requests collapse into a single refresh that runs once the next token is available.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Store Model")
+	void RequestRefreshStoreData();
+
+	/**
+	 * Fetches only what changed since KnownStoreVersion and applies it to the cached lists in place.
+	 * Falls back to RefreshStoreData when no version is known yet or the provider can't bridge the gap.
+	 */
+	UFUNCTION(BlueprintNativeEvent, Category = "Store Model")
+	void SyncStoreChanges();
+
 
 	// Predefined categories that are always added to the store model.
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Store Model|CategoryTabs")
 	TArray<FCategoryTabDefinition> DefaultCategoryTabs_AvailableItems;
 
+	// When the filter query only narrows the previous one (e.g. a character was appended), filter the previous matches instead of the whole catalog.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Store Model|Filtering")
+	bool bRefineNarrowingFilters = true;
+
+	// Run filter passes on a worker thread so large catalogs don't hitch the game thread while typing.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Store Model|Filtering")
+	bool bUseAsyncFiltering = false;
+
+	// Catalogs smaller than this are still filtered synchronously, where a worker round trip costs more than it saves.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Store Model|Filtering", meta = (EditCondition = "bUseAsyncFiltering", ClampMin = 0))
+	int32 AsyncFilterMinItems = 5000;
+
+	/**
+	 * Publish AvailableItems and OwnedItems as full lists on the StoreViewModel.
+	 * Turn off for very large catalogs whose views bind to the windowed collections instead, so ItemViewModels only
+	 * exist for the entries that are on screen.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Store Model|Windowing")
+	bool bPublishFullItemLists = true;
+
+	// Fuzzy searches publish only this many of the best-scoring items. Zero or less publishes every match.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Store Model|Filtering")
+	int32 MaxFuzzyResults = 200;
+
+	// Upper bound on cached ItemViewModels. Past it, the least recently used ones that no list references are evicted. Zero disables eviction.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Store Model|Caching", meta = (ClampMin = 0))
+	int32 ItemViewModelCacheCapacity = 4096;
+
+	// Evicted ItemViewModels kept around to be reset and reused. Evictions past this many are left to GC.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Store Model|Caching", meta = (ClampMin = 0))
+	int32 ItemViewModelPoolCapacity = 256;
+
+	/** Hit, miss and eviction counts of the ItemViewModel cache since the model was initialized. */
+	UFUNCTION(BlueprintPure, Category = "Store Model|Caching")
+	FMolecularCacheStats GetItemViewModelCacheStats() const { return ItemViewModelCacheStats; }
+
+	// Items requested per catalog page. Each page is indexed and shown as it arrives.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Store Model|Loading", meta = (ClampMin = 1))
+	int32 StoreItemsPageSize = 500;
+
+	// Refreshes RequestRefreshStoreData runs back to back before it starts spacing them out.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Store Model|Loading", meta = (ClampMin = 1))
+	int32 RefreshBurstLimit = 2;
+
+	// Refreshes RequestRefreshStoreData allows per second once the burst is spent.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Store Model|Loading", meta = (ClampMin = 0))
+	float RefreshTokensPerSecond = 0.2f;
+
 	// Whether to automatically generate categories based on the store items.
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Store Model|CategoryTabs")
 	bool bAutoGenerateCategoriesFromItems = true;
@@ -96,6 +191,12 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Store Model|CategoryTabs")
 	FName StoreViewModel_Name = FName(TEXT("StoreViewModel"));
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Store Model|Windowing")
+	FName AvailableItemsWindow_Name = FName(TEXT("AvailableItemsWindow"));
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Store Model|Windowing")
+	FName OwnedItemsWindow_Name = FName(TEXT("OwnedItemsWindow"));
+
 	
 	// Manages store item selection and reflects the current selection state.
 	UPROPERTY(EditAnywhere, Instanced, BlueprintReadWrite, Category = "Store Model|Selection")
@@ -109,21 +210,137 @@ protected:
 	UPROPERTY(BlueprintReadWrite, Transient)
 	TObjectPtr<UStoreViewModel> StoreViewModel = nullptr;
 
+	// Windowed views over the filtered available items and the owned items.
+	UPROPERTY(EditAnywhere, Instanced, BlueprintReadWrite, Category = "Store Model|Windowing")
+	TObjectPtr<UWindowedCollectionViewModel> AvailableItemsWindow = nullptr;
+
+	UPROPERTY(EditAnywhere, Instanced, BlueprintReadWrite, Category = "Store Model|Windowing")
+	TObjectPtr<UWindowedCollectionViewModel> OwnedItemsWindow = nullptr;
+
 	// Holds all ViewModels for the store Model
 	UPROPERTY(Transient)
 	TObjectPtr<UMVVMViewModelCollectionObject> StoreViewModelCollection = nullptr;
 	
 
-	// Cache for item view models to reduce UObject churn.
+	// Handles for every item the model has received. ItemIds are converted here once, when items are ingested.
+	FStoreItemRegistry ItemRegistry;
+
+	// Cache for item view models to reduce UObject churn, indexed by FStoreItemHandle::Index. Null where nothing is cached.
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UItemViewModel>> ItemViewModelCache;
+	int32 NumCachedItemViewModels = 0;
+
+	// When each cached ItemViewModel was last handed out, as a value of ItemViewModelUseCounter. Indexed like the cache.
+	TArray<uint64> ItemViewModelLastUse;
+	uint64 ItemViewModelUseCounter = 0;
+
+	// Evicted ItemViewModels, unbound and reset, waiting to be reused by GetOrCreateItemViewModel.
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UItemViewModel>> ItemViewModelPool;
+
+	FMolecularCacheStats ItemViewModelCacheStats;
+
+	// One category ViewModel per tag, shared by the category tabs and every item carrying the tag.
+	UPROPERTY(Transient)
+	TMap<FGameplayTag, TObjectPtr<UCategoryViewModel>> CategoryViewModelRegistry;
+
+	// UMolecularUISettings::CategoryUIDefinitions resolved at init, with icons filled in as their batches load.
 	UPROPERTY(Transient)
-	TMap<FName, TObjectPtr<UItemViewModel>> ItemViewModelCache;
+	TMap<FGameplayTag, FStandardUIData> ResolvedCategoryUIData;
 
-	// Cached list of store items used for filtering without repeated backend calls.
+	// Category icons are requested in batches of this many, so the first ones show without waiting for all of them.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Store Model|CategoryTabs", meta = (ClampMin = 1))
+	int32 CategoryIconLoadBatchSize = 16;
+
+	// Keeps the loaded category icons alive, and lets Deinit cancel batches still in flight.
+	TArray<TSharedPtr<FStreamableHandle>> CategoryIconLoadHandles;
+
+	// Cached list of store items, indexed like CatalogIndex. Filter passes read the index's hot columns, and only
+	// ViewModel creation reads these full rows. Rows a change set removed stay as tombstones until the index is rebuilt.
 	UPROPERTY(BlueprintReadWrite, Transient)
 	TArray<FStoreItem> CachedStoreItems;
 
-	// Cached interface pointer to the provider instance.
+	// The owned items as last received, backing OwnedItemsWindow.
+	UPROPERTY(Transient)
+	TArray<FStoreItem> CachedOwnedItems;
+
+	// The provider snapshot CachedOwnedItems was copied from. Reset once the list is patched locally, since it no longer matches.
+	TSharedPtr<const FStoreCatalogSnapshot> OwnedItemsSnapshot;
+
+	// Text and category indexes over CachedStoreItems. Changed in place while this is the only reference, and copied
+	// first while an async filter pass still reads it, see FStoreCatalogIndex.
+	TSharedPtr<const FStoreCatalogIndex> CatalogIndex;
+
+	// The query of the last applied filter pass and the CachedStoreItems indices it matched, kept for refinement.
+	FStoreFilterQuery LastFilterQuery;
+	TArray<int32> LastFilterMatches;
+	bool bHasLastFilterResult = false;
+
+	// Category tab counts for LastFacetQuery's text. Only recounted when the text or search mode changes, change sets
+	// and transactions patch them in PatchStoreItems.
+	FStoreFacetCounts FacetCounts;
+	FStoreFilterQuery LastFacetQuery;
+	bool bHasFacetCounts = false;
+
+	// Incremented by every filter pass. Async results are only applied if no newer pass has started since.
+	TSharedRef<std::atomic<uint32>> FilterGeneration = MakeShared<std::atomic<uint32>>(0);
+
+	// Set while a coalesced filter pass is waiting for the end of the tick.
+	FDelegateHandle PendingFilterHandle;
+
+	// Restarted by each debounced filter request.
+	FTimerHandle FilterDebounceHandle;
+
+	// Incremented by every catalog fetch and by Deinit. Pages of an older fetch are dropped.
+	uint32 StoreItemsFetchSerial = 0;
+
+	// Pages of a catalog reload, kept aside until the last one arrives so the previous catalog stays published.
+	TArray<FStoreItem> ReloadedStoreItems;
+	int64 ReloadedStoreVersion = INDEX_NONE;
+	bool bReloadingStoreItems = false;
+
+	// A bit per handle of the items the pages of the current fetch listed, to drop the ones a page repeats.
+	TBitArray<> LoadedPageHandles;
+
+	// A transaction shown as done while its provider call is in flight.
+	struct FPendingTransaction
+	{
+		uint32 Id = 0;
+		bool bPurchase = true;
+
+		// The moved items as they were before the projection, put back if the transaction fails.
+		TArray<FStoreItem> OriginalItems;
+
+		// For a sale, where each of OriginalItems was in CachedOwnedItems. A purchase needs none, since the store list
+		// keeps a removed item's row until its index is rebuilt.
+		TArray<int32> OriginalOwnedIndices;
+
+		// The projected list changes, re-applied over authoritative change sets until the transaction settles.
+		FStoreChangeSet Projection;
+		int32 CurrencyDelta = 0;
+	};
+	TArray<FPendingTransaction> PendingTransactions;
+	uint32 TransactionSerial = 0;
+
+	// Store version the cached lists are up to date with, or INDEX_NONE before the first catalog page arrives.
+	int64 KnownStoreVersion = INDEX_NONE;
+
+	// Set while catalog pages are still arriving. A change sync waits for the last page, which may already contain it.
+	bool bLoadingStoreItemPages = false;
+	bool bStoreChangesPending = false;
+
+	// Cached interface pointer to the provider instance. Points at StoreDataProviderMultiplexer once initialized.
 	TScriptInterface<IStoreDataProvider> StoreDataProviderInterface;
+
+	// Shares concurrent fetches of the same resource and queues transactions, in front of the actual provider.
+	UPROPERTY(Transient)
+	TObjectPtr<UStoreDataProviderMultiplexer> StoreDataProviderMultiplexer = nullptr;
+
+	// Spaces out player-requested refreshes, see RequestRefreshStoreData.
+	FMolecularTokenBucket RefreshBucket;
+
+	// Set while a refresh waits for the bucket to refill. Requests made meanwhile are covered by it.
+	FTimerHandle TrailingRefreshHandle;
 	
 	/**
 	 * Centralized factory method for ItemViewModels.
@@ -133,4 +350,160 @@ protected:
 	 * @return A valid UItemViewModel pointer.
 	 */
 	UItemViewModel* GetOrCreateItemViewModel(const FStoreItem& ItemData);
+
+	// GetOrCreateItemViewModel for a received list, in order. Repeated items are dropped with a bit per item handle.
+	TArray<TObjectPtr<UItemViewModel>> GetOrCreateItemViewModels(TConstArrayView<FStoreItem> Items);
+
+	/**
+	 * Returns the interned category ViewModel for a tag, creating and binding it on first use.
+	 * Its interactions are routed by InteractionSource, since one instance stands in for the tab and every item's category.
+	 */
+	UCategoryViewModel* GetOrCreateCategoryViewModel(const FGameplayTag& CategoryTag);
+
+	// Adds a tab for every category of a received catalog batch that doesn't have one yet, broadcasting once.
+	void SyncCategoryTabs(TConstArrayView<FStoreItem> Items);
+
+	/**
+	 * Appends a received catalog page to CachedStoreItems and the catalog index, then refilters. When a catalog is
+	 * already loaded, the pages go to ReloadedStoreItems instead and replace it at the last one.
+	 * @param bFirstPage Replace the previous catalog instead of extending it.
+	 */
+	void AppendStoreItemsPage(FStoreItemPage&& Page, const bool bFirstPage);
+
+	/**
+	 * Replaces CachedStoreItems with a finished reload, rebuilds the index and reprojects pending transactions.
+	 * The previous matches are carried over by item until the refilter lands, and unlisted items are released.
+	 */
+	void SwapInReloadedStoreItems();
+
+	// Drops the pages of a reload that failed or was overtaken, releasing the handles only they held.
+	void DiscardReloadedStoreItems();
+
+	/**
+	 * Drops the rows from FirstNewItem on whose item an earlier page or row of the current fetch already listed,
+	 * keeping the first. Rows must already carry their handles. Every item then has one row, and the published lists
+	 * never hold its ViewModel twice.
+	 */
+	void DropRepeatedItems(TArray<FStoreItem>& Items, const int32 FirstNewItem);
+
+	/**
+	 * Replaces CachedOwnedItems with a received snapshot and republishes them.
+	 * A snapshot the list was already copied from is skipped, without touching a row or an ItemViewModel.
+	 */
+	void IngestOwnedItems(const TSharedRef<const FStoreCatalogSnapshot>& Snapshot);
+
+	// Applies a fetched change set to the cached lists, their indexes and the currency, keeping pending transactions projected.
+	void ApplyStoreChanges(FStoreChangeSet&& Changes);
+
+	// Applies the list changes of a change set to the cached lists and their indexes. The currency is left to the caller.
+	void ApplyItemListChanges(FStoreChangeSet&& Changes);
+
+	// Folds the list changes of Later into Into, so applying Into once does what applying both in order would.
+	static void MergeChangeSets(FStoreChangeSet& Into, const FStoreChangeSet& Later);
+
+	// Republishes CachedOwnedItems after a change, to the owned window and the full list if it is published.
+	void PublishOwnedItems();
+
+	// Whether the store states let a trade start: ready, or only syncing changes and running other trades.
+	bool CanStartTransaction() const;
+
+	/**
+	 * Moves a transaction's items between the cached lists and adjusts the currency right away, as the provider is expected to.
+	 * @return Id to settle the projection with, or 0 if nothing was projected because the local state already says the request fails.
+	 */
+	uint32 ProjectTransaction(const FTransactionRequest& Request, const bool bPurchase);
+
+	// Undoes the projection of a transaction the provider rejected.
+	void RollbackTransaction(const uint32 TransactionId);
+
+	// Drops the projection of a transaction the provider accepted, and syncs the authoritative result over it.
+	void ConfirmTransaction(const uint32 TransactionId);
+
+	/**
+	 * Replaces the entries of Items that have an upsert, drops the removed ones and appends the remaining upserts, in one pass.
+	 * Upserts and Items must already carry their handles.
+	 */
+	void ApplyItemChanges(TArray<FStoreItem>& Items, TArray<FStoreItem>&& Upserts, TConstArrayView<FStoreItemHandle> Removals) const;
+
+	/**
+	 * Applies store list changes to CachedStoreItems, patches CatalogIndex to match and requests a refilter.
+	 * Removed rows stay in place as tombstones, and an item that comes back takes its old row again. Once tombstones
+	 * make up a quarter of the catalog, RebuildCatalogIndex compacts them away. FacetCounts is patched for the touched rows.
+	 */
+	void PatchStoreItems(TArray<FStoreItem>&& Upserts, TConstArrayView<FStoreItemHandle> Removals);
+
+	// Drops the cached ItemViewModel of an item that left the store for good, then frees its handle for reuse.
+	void ReleaseItemHandle(const FStoreItemHandle Handle);
+
+	// Releases the handles that neither cached list nor a pending transaction holds anymore. Called by every path that drops items.
+	void ReleaseItemHandlesIfUnused(TConstArrayView<FStoreItemHandle> Handles);
+
+	// Fills ResolvedCategoryUIData from the project settings and starts loading the category icons.
+	void ResolveCategoryUIData();
+
+	// Sets the icons of a loaded batch on the resolved UI data and on any category ViewModels already created for it.
+	void HandleCategoryIconsLoaded(TArray<FGameplayTag> LoadedTags);
+
+	/**
+	 * Evicts the least recently used ItemViewModels that no published list, window or selection references,
+	 * once the cache grows past ItemViewModelCacheCapacity.
+	 */
+	void TrimItemViewModelCache();
+
+	// Unbinds and resets an evicted ItemViewModel, then pools it for reuse if the pool has room.
+	void RecycleItemViewModel(UItemViewModel* ItemVM);
+
+	// Captures the current filter text and category tab selection.
+	FStoreFilterQuery MakeFilterQuery() const;
+
+	// Stamps FStoreItem::ContentHash on received items, so cache hits can tell unchanged items apart in one compare.
+	static void StampContentHashes(TArrayView<FStoreItem> Items);
+
+	// Stamps FStoreItem::Handle on received items. This is where items from the provider get their dense identity.
+	void AssignItemHandles(TArrayView<FStoreItem> Items);
+
+	/**
+	 * Drops the tombstones from CachedStoreItems, rebuilds CatalogIndex from the rest and requests a refilter.
+	 * The previous matches are moved to their rows' new positions, and results in flight are dropped.
+	 */
+	void RebuildCatalogIndex();
+
+	// CatalogIndex, for changes in place. Copied first if an async filter pass still reads it, or created if there is none.
+	TSharedRef<FStoreCatalogIndex> MakeCatalogIndexWritable();
+
+	/**
+	 * Extends CatalogIndex with the entries CachedStoreItems gained since it was built. The index is extended in place
+	 * when nothing else holds it. While an async filter pass is still reading it, a page is left for later, and only the
+	 * last one copies the index.
+	 * @param bBuildOrderings Also sort the whole catalog for cost ranges and sorting and bucket its costs, once no more pages are coming.
+	 */
+	void AppendToCatalogIndex(const bool bBuildOrderings);
+
+	// Search keys are folded with the active culture's rules, so they are rebuilt when it changes.
+	void HandleCultureChanged();
+
+	/**
+	 * Publishes the items matched by a filter pass to the StoreViewModel and remembers them for refinement.
+	 * @param NewFacets Category counts the pass recounted, or null if the text didn't change since the last count.
+	 */
+	void ApplyFilterResult(const FStoreFilterQuery& Query, TArray<int32>&& Matches, FStoreFacetCounts* NewFacets);
+
+	// Copies FacetCounts onto the category tabs' MatchCount.
+	void PublishFacetCounts();
+
+	// Converts the ItemIds of a transaction request, which comes from the provider's side of the boundary.
+	TArray<FStoreItemHandle> FindItemHandles(const TArray<FName>& ItemIds) const;
+
+	/**
+	 * Fills a windowed collection with the entries around its visible range.
+	 * The ItemViewModel cache is left to the caller to trim, once every list it changes is published.
+	 *
+	 * @param WindowVM The window to update.
+	 * @param TotalCount Number of entries in the full list.
+	 * @param GetItem Returns the ViewModel for an index of the full list. Only called for indices inside the window.
+	 * @param bForce Rebuild even if the visible range is already covered, e.g. because the list contents changed.
+	 */
+	void RefreshItemWindow(UWindowedCollectionViewModel* WindowVM, const int32 TotalCount, TFunctionRef<UItemViewModel*(int32)> GetItem, const bool bForce);
+	void RefreshAvailableItemsWindow(const bool bForce);
+	void RefreshOwnedItemsWindow(const bool bForce);
 };
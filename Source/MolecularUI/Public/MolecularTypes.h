@@ -4,6 +4,7 @@
 
 #include <CoreMinimal.h>
 #include <GameplayTagContainer.h>
+#include <Hash/CityHash.h>
 #include <Misc/DataValidation.h>
 
 #include "MolecularUITags.h"
@@ -37,6 +38,33 @@ struct FStandardUIData
 	}
 };
 
+/**
+ * Dense, model-assigned identity of a store item: a slot index plus the generation of the slot it was issued for.
+ * Lookups index arrays directly instead of hashing ItemIds. A handle whose item was released no longer matches its
+ * slot's generation, so it can't alias the item that reuses the slot. Only the provider boundary deals in ItemIds.
+ */
+USTRUCT(BlueprintType)
+struct FStoreItemHandle
+{
+	GENERATED_BODY()
+
+	FStoreItemHandle() = default;
+	FStoreItemHandle(const int32 InIndex, const uint32 InGeneration)
+		: Index(InIndex), Generation(InGeneration) {}
+
+	int32 Index = INDEX_NONE;
+	uint32 Generation = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	bool operator==(const FStoreItemHandle& Other) const { return Index == Other.Index && Generation == Other.Generation; }
+	bool operator!=(const FStoreItemHandle& Other) const { return !(*this == Other); }
+
+	friend uint32 GetTypeHash(const FStoreItemHandle& Handle) { return HashCombineFast(::GetTypeHash(Handle.Index), ::GetTypeHash(Handle.Generation)); }
+
+	FString ToString() const { return FString::Printf(TEXT("%d.%u"), Index, Generation); }
+};
+
 // Represents a single item available for purchase in the store.
 USTRUCT(BlueprintType)
 struct FStoreItem : public FTableRowBase
@@ -62,8 +90,38 @@ struct FStoreItem : public FTableRowBase
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Store Item", meta = (Categories = "Item.Category"))
 	FGameplayTagContainer Categories;
 
+	// 64-bit stamp of the fields above, set once when the item is ingested. Zero means unstamped.
+	// A backend can provide its own revision here instead, as long as it changes whenever the content does.
+	uint64 ContentHash = 0;
+
+	// Assigned by the store model when the item is ingested, invalid until then. Not part of the item's content.
+	FStoreItemHandle Handle;
+
+	/** Hashes every field that affects the item's presentation. */
+	uint64 ComputeContentHash() const
+	{
+		uint64 Hash = CityHash64WithSeed(reinterpret_cast<const char*>(&Cost), sizeof(Cost), GetTypeHash(ItemId));
+		Hash = CombineHash64(Hash, bIsOwned ? 1 : 0);
+		Hash = HashText(UIData.DisplayName, Hash);
+		Hash = HashText(UIData.Description, Hash);
+		Hash = HashBrush(UIData.Icon, Hash);
+		for (const FGameplayTag& Category : Categories)
+		{
+			Hash = CombineHash64(Hash, GetTypeHash(Category));
+		}
+		// Keep zero free to mean "unstamped".
+		return Hash != 0 ? Hash : 1;
+	}
+
+	void UpdateContentHash() { ContentHash = ComputeContentHash(); }
+
 	bool operator==(const FStoreItem& Other) const
 	{
+		// Stamped items compare in one step. Colliding 64-bit hashes are too unlikely to guard against.
+		if (ContentHash != 0 && Other.ContentHash != 0)
+		{
+			return ContentHash == Other.ContentHash && ItemId == Other.ItemId;
+		}
 		return ItemId == Other.ItemId
 			&& Cost == Other.Cost
 			&& bIsOwned == Other.bIsOwned
@@ -95,6 +153,47 @@ struct FStoreItem : public FTableRowBase
 		return EDataValidationResult::Valid;
 	}
 	// End FTableRowBase overrides
+
+private:
+	static uint64 HashText(const FText& Text, const uint64 Seed)
+	{
+		const FString& String = Text.ToString();
+		return CityHash64WithSeed(reinterpret_cast<const char*>(*String), String.Len() * sizeof(TCHAR), Seed);
+	}
+
+	static uint64 CombineHash64(const uint64 Hash, const uint64 Value)
+	{
+		return CityHash128to64(Uint128_64(Hash, Value));
+	}
+
+	static uint64 HashSlateColor(const FSlateColor& Color, const uint64 Seed)
+	{
+		uint64 Hash = CombineHash64(Seed, static_cast<uint64>(Color.GetColorUseRule()));
+		return CombineHash64(Hash, GetTypeHash(Color.GetSpecifiedColor()));
+	}
+
+	// operator== trusts the hash, so every brush field that changes how the icon renders has to be in it.
+	static uint64 HashBrush(const FSlateBrush& Brush, const uint64 Seed)
+	{
+		uint64 Hash = CombineHash64(Seed, GetTypeHash(Brush.GetResourceName()));
+		Hash = CombineHash64(Hash, GetTypeHash(Brush.GetResourceObject()));
+		Hash = CombineHash64(Hash, GetTypeHash(FVector2D(Brush.ImageSize)));
+		Hash = CombineHash64(Hash, static_cast<uint64>(Brush.DrawAs.GetValue()));
+		Hash = CombineHash64(Hash, static_cast<uint64>(Brush.Tiling.GetValue()));
+		Hash = CombineHash64(Hash, static_cast<uint64>(Brush.Mirroring.GetValue()));
+		Hash = CombineHash64(Hash, static_cast<uint64>(Brush.GetImageType()));
+		Hash = CombineHash64(Hash, GetTypeHash(FVector4(Brush.Margin.Left, Brush.Margin.Top, Brush.Margin.Right, Brush.Margin.Bottom)));
+		const auto UVRegion = Brush.GetUVRegion();
+		Hash = CombineHash64(Hash, UVRegion.bIsValid ? GetTypeHash(FVector4(UVRegion.Min.X, UVRegion.Min.Y, UVRegion.Max.X, UVRegion.Max.Y)) : 0);
+		Hash = HashSlateColor(Brush.TintColor, Hash);
+
+		const FSlateBrushOutlineSettings& Outline = Brush.OutlineSettings;
+		Hash = CombineHash64(Hash, GetTypeHash(FVector4(Outline.CornerRadii)));
+		Hash = HashSlateColor(Outline.Color, Hash);
+		Hash = CombineHash64(Hash, GetTypeHash(Outline.Width));
+		Hash = CombineHash64(Hash, static_cast<uint64>(Outline.RoundingType.GetValue()));
+		return CombineHash64(Hash, Outline.bUseBrushTransparency ? 1 : 0);
+	}
 };
 
 UENUM(BlueprintType)
@@ -105,6 +204,76 @@ enum class ETransactionType : uint8
 	Sell,
 };
 
+/**
+ * A complete item list as the provider read it, handed out as TSharedRef<const FStoreCatalogSnapshot>.
+ *
+ * Never modified once shared. Every fetch that finds the backend list unchanged gets the same snapshot, and every
+ * caller of one fetch shares it, so receivers can tell an unchanged list apart by pointer without comparing rows.
+ */
+struct FStoreCatalogSnapshot
+{
+	TArray<FStoreItem> Items;
+
+	// Store version the list was read at.
+	int64 Version = 0;
+
+	/** Takes ownership of the rows and stamps the ones without a ContentHash, once for every receiver. */
+	static TSharedRef<const FStoreCatalogSnapshot> Create(TArray<FStoreItem>&& InItems, const int64 InVersion)
+	{
+		TSharedRef<FStoreCatalogSnapshot> Snapshot = MakeShared<FStoreCatalogSnapshot>();
+		Snapshot->Items = MoveTemp(InItems);
+		Snapshot->Version = InVersion;
+		for (FStoreItem& Item : Snapshot->Items)
+		{
+			if (Item.ContentHash == 0)
+			{
+				Item.UpdateContentHash();
+			}
+		}
+		return Snapshot;
+	}
+};
+
+// One page of a paged catalog fetch, see IStoreDataProvider::FetchStoreItemsPage.
+struct FStoreItemPage
+{
+	TArray<FStoreItem> Items;
+
+	// Pass back to fetch the next page. Empty on the last page.
+	FString NextCursor;
+
+	// Store version the page was read at. Change sets from the first page's version catch up with anything later pages missed.
+	int64 Version = 0;
+
+	bool IsLastPage() const { return NextCursor.IsEmpty(); }
+};
+
+// Everything that changed in the store since a version, see IStoreDataProvider::FetchStoreChanges.
+struct FStoreChangeSet
+{
+	// Store items added or changed, with their current data, and the ItemIds no longer in the store.
+	TArray<FStoreItem> StoreUpserts;
+	TArray<FName> StoreRemovals;
+
+	// The same for the player's owned items.
+	TArray<FStoreItem> OwnedUpserts;
+	TArray<FName> OwnedRemovals;
+
+	// The player's currency, if it changed.
+	TOptional<int32> PlayerCurrency;
+
+	// The version this change set brings the caller up to.
+	int64 Version = 0;
+
+	// Set when the provider can't list the changes since the requested version. The caller has to fetch everything again.
+	bool bRequiresFullRefresh = false;
+
+	bool IsEmpty() const
+	{
+		return StoreUpserts.IsEmpty() && StoreRemovals.IsEmpty() && OwnedUpserts.IsEmpty() && OwnedRemovals.IsEmpty() && !PlayerCurrency.IsSet();
+	}
+};
+
 // Wrapper that represents a user's request to purchase or sell an item.
 // This struct is used for the "Stateful Communication" or "Intent Channel".
 // A NAME_None ItemId means no request is active.
@@ -144,6 +313,78 @@ struct FTransactionRequest
 	}
 };
 
+// How the store's filter text is matched against item names.
+UENUM(BlueprintType)
+enum class EStoreSearchMode : uint8
+{
+	// Names containing the filter text, ignoring case.
+	Substring,
+	// Names containing the filter text's characters in order, tolerating a few typos. Results are ranked by score.
+	Fuzzy,
+};
+
+// Item property the store's results can be ordered by.
+UENUM(BlueprintType)
+enum class EStoreSortField : uint8
+{
+	// Keep the order the backend returned the catalog in.
+	None,
+	Cost,
+	Name,
+	// Primary category tag, then name.
+	Category,
+};
+
+// Requested ordering of the store's item lists. Set through the StoreViewModel's intent channel.
+USTRUCT(BlueprintType)
+struct FStoreSortMode
+{
+	GENERATED_BODY()
+
+	FStoreSortMode() = default;
+	FStoreSortMode(const EStoreSortField InField, const bool bInDescending = false)
+		: Field(InField), bDescending(bInDescending) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sort Mode")
+	EStoreSortField Field = EStoreSortField::None;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sort Mode")
+	bool bDescending = false;
+
+	bool operator==(const FStoreSortMode& Other) const
+	{
+		return Field == Other.Field && bDescending == Other.bDescending;
+	}
+};
+
+// Distribution of item costs in equal-width buckets, for drawing a price range slider.
+USTRUCT(BlueprintType)
+struct FStoreCostHistogram
+{
+	GENERATED_BODY()
+
+	// Cost at the start of the first bucket.
+	UPROPERTY(BlueprintReadOnly, Category = "Cost Histogram")
+	int32 MinCost = 0;
+
+	// Highest cost in the last bucket.
+	UPROPERTY(BlueprintReadOnly, Category = "Cost Histogram")
+	int32 MaxCost = 0;
+
+	// Range of costs each bucket covers. Bucket N holds costs from MinCost + N * BucketWidth.
+	UPROPERTY(BlueprintReadOnly, Category = "Cost Histogram")
+	int32 BucketWidth = 1;
+
+	// Number of items in each bucket.
+	UPROPERTY(BlueprintReadOnly, Category = "Cost Histogram")
+	TArray<int32> Counts;
+
+	bool operator==(const FStoreCostHistogram& Other) const
+	{
+		return MinCost == Other.MinCost && MaxCost == Other.MaxCost && BucketWidth == Other.BucketWidth && Counts == Other.Counts;
+	}
+};
+
 /** Basic interaction events that widgets can choose to emit. */
 UENUM(BlueprintType)
 enum class EStatefulInteraction : uint8
@@ -212,6 +453,27 @@ struct FCategoryTabDefinition
 	FStandardUIData UIData;
 };
 
+// Project-wide UI data for an item category, see UMolecularUISettings::CategoryUIDefinitions.
+USTRUCT(BlueprintType)
+struct FCategoryUIDefinition
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Category UI")
+	FText DisplayName;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Category UI")
+	FText Description;
+
+	// Loaded asynchronously and set as the resource of IconBrush once it arrives.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Category UI", Meta = (AllowedClasses = "/Script/Engine.Texture,/Script/Engine.MaterialInterface"))
+	TSoftObjectPtr<UObject> IconResource;
+
+	// Size, tint and draw settings of the icon. Its resource object is ignored in favor of IconResource.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Category UI")
+	FSlateBrush IconBrush;
+};
+
 // Used to define how a user can select items in the UI, managed by a SelectionViewModel
 UENUM(BlueprintType)
 enum class EMolecularSelectionMode : uint8
@@ -221,4 +483,125 @@ enum class EMolecularSelectionMode : uint8
 	SingleToggle,
 	Multi,
 	MultiLimited
-};
\ No newline at end of file
+};
+
+UENUM(BlueprintType)
+enum class EMolecularCollectionChange : uint8
+{
+	// Count items were inserted at Index.
+	Insert,
+	// Count items were removed starting at Index.
+	Remove,
+	// Count items starting at Index were moved so they now start at ToIndex.
+	Move,
+	// The list changed too much to describe, rebuild from the full list.
+	Reset,
+};
+
+// One contiguous edit to an item list.
+USTRUCT(BlueprintType)
+struct FMolecularCollectionChange
+{
+	GENERATED_BODY()
+
+	FMolecularCollectionChange() = default;
+	FMolecularCollectionChange(const EMolecularCollectionChange InType, const int32 InIndex, const int32 InCount, const int32 InToIndex = INDEX_NONE)
+		: Type(InType), Index(InIndex), Count(InCount), ToIndex(InToIndex) {}
+
+	UPROPERTY(BlueprintReadOnly, Category = "Collection Change")
+	EMolecularCollectionChange Type = EMolecularCollectionChange::Reset;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Collection Change")
+	int32 Index = INDEX_NONE;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Collection Change")
+	int32 Count = 0;
+
+	// Destination of a Move, as an index into the list after the moved items were taken out.
+	UPROPERTY(BlueprintReadOnly, Category = "Collection Change")
+	int32 ToIndex = INDEX_NONE;
+
+	bool operator==(const FMolecularCollectionChange& Other) const
+	{
+		return Type == Other.Type && Index == Other.Index && Count == Other.Count && ToIndex == Other.ToIndex;
+	}
+};
+
+/*
+ * The edits that turn the previous contents of an item list into its current contents.
+ * Applying Changes in order to the previous list, with indices relative to the list as edited so far, yields the current list.
+ */
+USTRUCT(BlueprintType)
+struct FMolecularCollectionChangeSet
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Collection Change")
+	TArray<FMolecularCollectionChange> Changes;
+
+	// Incremented for every published change set. A consumer that skipped a revision should rebuild from the full list.
+	UPROPERTY(BlueprintReadOnly, Category = "Collection Change")
+	int32 Revision = 0;
+
+	bool IsReset() const
+	{
+		return Changes.Num() == 1 && Changes[0].Type == EMolecularCollectionChange::Reset;
+	}
+
+	// We need a custom equality operator for UE_MVVM_SET_PROPERTY_VALUE to work.
+	bool operator==(const FMolecularCollectionChangeSet& Other) const
+	{
+		return Revision == Other.Revision && Changes == Other.Changes;
+	}
+};
+
+// The slice of a list that a view is currently showing, reported through a windowed collection's intent channel.
+USTRUCT(BlueprintType)
+struct FMolecularVisibleRange
+{
+	GENERATED_BODY()
+
+	FMolecularVisibleRange() = default;
+	FMolecularVisibleRange(const int32 InFirstIndex, const int32 InNum, const float InScrollOffset = 0.0f)
+		: FirstIndex(InFirstIndex), Num(InNum), ScrollOffset(InScrollOffset) {}
+
+	// Index of the first visible entry.
+	UPROPERTY(BlueprintReadWrite, Category = "Visible Range")
+	int32 FirstIndex = 0;
+
+	// Number of visible entries.
+	UPROPERTY(BlueprintReadWrite, Category = "Visible Range")
+	int32 Num = 0;
+
+	// Scroll position reported by the list widget, in entries. Kept so a rebuilt view can restore it.
+	UPROPERTY(BlueprintReadWrite, Category = "Visible Range")
+	float ScrollOffset = 0.0f;
+
+	bool operator==(const FMolecularVisibleRange& Other) const
+	{
+		return FirstIndex == Other.FirstIndex && Num == Other.Num && ScrollOffset == Other.ScrollOffset;
+	}
+};
+
+// Usage counters for a ViewModel cache.
+USTRUCT(BlueprintType)
+struct FMolecularCacheStats
+{
+	GENERATED_BODY()
+
+	// Lookups answered by a cached ViewModel.
+	UPROPERTY(BlueprintReadOnly, Category = "Cache Stats")
+	int64 Hits = 0;
+
+	// Lookups that had to produce a ViewModel, either from the reuse pool or by creating one.
+	UPROPERTY(BlueprintReadOnly, Category = "Cache Stats")
+	int64 Misses = 0;
+
+	// ViewModels evicted to keep the cache under capacity.
+	UPROPERTY(BlueprintReadOnly, Category = "Cache Stats")
+	int64 Evictions = 0;
+
+	// Misses served from the reuse pool instead of a new object.
+	UPROPERTY(BlueprintReadOnly, Category = "Cache Stats")
+	int64 PoolReuses = 0;
+};
@@ -26,10 +26,16 @@ public:
 
 	UFUNCTION(BlueprintPure, Category = "MolecularUI Settings")
 	static const FSlateBrush& GetDefaultStoreIcon();
+
+	static const TMap<FGameplayTag, FCategoryUIDefinition>& GetCategoryUIDefinitions();
 protected:
 	UPROPERTY(EditAnywhere, Config, Category = "MolecularUI")
 	TSoftObjectPtr<UDataTable> DefaultItemsDataTable = nullptr;
 	
 	UPROPERTY(EditAnywhere, Config, Category = "MolecularUI")
 	FSlateBrush DefaultStoreIcon = FSlateBrush();
+
+	// UI data for item categories, resolved once when a store model initializes. Categories missing here fall back to their tag name.
+	UPROPERTY(EditAnywhere, Config, Category = "MolecularUI|Categories", Meta = (ForceInlineRow, Categories = "Item.Category"))
+	TMap<FGameplayTag, FCategoryUIDefinition> CategoryUIDefinitions;
 };
@@ -22,6 +22,7 @@ namespace MolecularUITags
 				TAG(Items);
 				TAG(OwnedItems);
 				TAG(Currency);
+				TAG(Changes);
 			}
 		}
 	}
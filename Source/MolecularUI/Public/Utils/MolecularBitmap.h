@@ -0,0 +1,89 @@
+// Copyright Mike Desrosiers, All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+
+/**
+ * Compressed bitmap of non-negative integers, laid out like a roaring bitmap.
+ *
+ * Values are split into 16-bit chunks keyed by their high bits. Sparse chunks store their low bits as a sorted
+ * array, dense chunks switch to a fixed 8 KB bit set. Unions and intersections work chunk by chunk, so their cost
+ * depends on how many values the operands hold rather than on the largest value.
+ */
+class MOLECULARUI_API FMolecularBitmap
+{
+public:
+	void Add(const int32 Value);
+	void Remove(const int32 Value);
+	bool Contains(const int32 Value) const;
+	void Reset() { Containers.Reset(); }
+
+	int32 Num() const;
+	bool IsEmpty() const { return Containers.IsEmpty(); }
+
+	FMolecularBitmap& operator|=(const FMolecularBitmap& Other);
+	FMolecularBitmap& operator&=(const FMolecularBitmap& Other);
+
+	/** Appends every value in ascending order. */
+	void ToArray(TArray<int32>& OutValues) const;
+
+	/** Invokes Func(int32) for every value in ascending order. */
+	template<typename FuncType>
+	void ForEach(FuncType&& Func) const
+	{
+		for (const FContainer& Container : Containers)
+		{
+			const int32 High = static_cast<int32>(Container.Key) << 16;
+			if (Container.IsBitmap())
+			{
+				for (int32 WordIndex = 0; WordIndex < Container.Words.Num(); ++WordIndex)
+				{
+					uint64 Word = Container.Words[WordIndex];
+					while (Word != 0)
+					{
+						const int32 Bit = static_cast<int32>(FPlatformMath::CountTrailingZeros64(Word));
+						Func(High | (WordIndex << 6) | Bit);
+						Word &= Word - 1;
+					}
+				}
+			}
+			else
+			{
+				for (const uint16 Low : Container.Values)
+				{
+					Func(High | Low);
+				}
+			}
+		}
+	}
+
+private:
+	struct FContainer
+	{
+		// The high 16 bits shared by every value in this container.
+		uint16 Key = 0;
+
+		// Sorted low 16 bits, used while the container is sparse.
+		TArray<uint16> Values;
+
+		// One bit per low value, used once the container is dense. Empty in array form.
+		TArray<uint64> Words;
+
+		int32 Cardinality = 0;
+
+		bool IsBitmap() const { return !Words.IsEmpty(); }
+		bool Contains(const uint16 Low) const;
+		void ConvertToBitmap();
+		void ConvertToArray();
+	};
+
+	// Past this many values, a bit set is smaller than a sorted array of 16-bit values.
+	static constexpr int32 MaxArrayCardinality = 4096;
+	static constexpr int32 NumBitmapWords = 65536 / 64;
+
+	const FContainer* FindContainer(const uint16 Key) const;
+
+	// Sorted by Key.
+	TArray<FContainer> Containers;
+};
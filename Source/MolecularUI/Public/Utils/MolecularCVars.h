@@ -19,6 +19,9 @@ namespace MolecularUI::CVars
 		extern float MinDelay;
 		extern float MaxDelay;
 		extern int32 NumDummyItems;
+		extern float PageMinDelay;
+		extern float PageMaxDelay;
+		extern float FilterDebounceSeconds;
 	}
 
 	namespace OwnedItems
@@ -0,0 +1,256 @@
+// Copyright Mike Desrosiers, All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+#include <Algo/BinarySearch.h>
+#include <Algo/Sort.h>
+
+#include "MolecularTypes.h"
+
+namespace MolecularUI::CollectionDiff
+{
+	namespace Private
+	{
+		// Running counts over a fixed number of slots, for list positions that shift as entries move.
+		struct FSlotCounts
+		{
+			explicit FSlotCounts(const int32 NumSlots) { Tree.SetNumZeroed(NumSlots + 1); }
+
+			void Add(int32 Slot, const int32 Delta)
+			{
+				for (++Slot; Slot < Tree.Num(); Slot += Slot & -Slot)
+				{
+					Tree[Slot] += Delta;
+				}
+			}
+
+			// Sum of the counts of the slots before Slot.
+			int32 CountBefore(int32 Slot) const
+			{
+				int32 Count = 0;
+				for (; Slot > 0; Slot -= Slot & -Slot)
+				{
+					Count += Tree[Slot];
+				}
+				return Count;
+			}
+
+		private:
+			TArray<int32> Tree;
+		};
+
+		// Marks the entries of one longest strictly increasing subsequence of Values. O(n log n).
+		inline TBitArray<> LongestIncreasingSubsequence(TConstArrayView<int32> Values)
+		{
+			// Tails[Length - 1] is the entry ending the increasing subsequence of that length with the smallest last value.
+			TArray<int32> Tails;
+			TArray<int32> Previous;
+			Previous.SetNumUninitialized(Values.Num());
+			for (int32 Index = 0; Index < Values.Num(); ++Index)
+			{
+				const int32 Length = Algo::LowerBoundBy(Tails, Values[Index], [&Values](const int32 Entry) { return Values[Entry]; });
+				Previous[Index] = Length > 0 ? Tails[Length - 1] : INDEX_NONE;
+				if (Length == Tails.Num())
+				{
+					Tails.Add(Index);
+				}
+				else
+				{
+					Tails[Length] = Index;
+				}
+			}
+
+			TBitArray<> OnSubsequence(false, Values.Num());
+			for (int32 Index = Tails.IsEmpty() ? INDEX_NONE : Tails.Last(); Index != INDEX_NONE; Index = Previous[Index])
+			{
+				OnSubsequence[Index] = true;
+			}
+			return OnSubsequence;
+		}
+	}
+
+	/**
+	 * Computes the insert, remove and move edits that turn Old into New.
+	 *
+	 * Removals are emitted back to front, then moves, then inserts front to back, so every index is valid against the
+	 * list as edited so far. The items that are already in New order relative to each other, as many as possible, stay
+	 * put and every other surviving item is moved once, so a reordered list costs as few moves as it can. The number of
+	 * edits is known before any move is built, and a list past MaxChanges costs O(n) before it falls back to a Reset.
+	 * Otherwise the whole diff is O(n log n). Items must be unique within each list. A repeated item has no single
+	 * position to move to, so it ensures and falls back to a Reset.
+	 *
+	 * @param Old The previous contents of the list.
+	 * @param New The current contents of the list.
+	 * @param MaxChanges Past this many edits a single Reset is emitted instead, since patching would cost more than a rebuild.
+	 * @param OutChanges Receives the edits.
+	 * @return False if the lists are identical and there is nothing to report.
+	 */
+	template<typename ItemType>
+	bool Compute(const TArray<ItemType>& Old, const TArray<ItemType>& New, const int32 MaxChanges, TArray<FMolecularCollectionChange>& OutChanges)
+	{
+		OutChanges.Reset();
+		if (Old == New)
+		{
+			return false;
+		}
+
+		auto EmitReset = [&OutChanges, &New]()
+		{
+			OutChanges.Reset();
+			OutChanges.Emplace(EMolecularCollectionChange::Reset, 0, New.Num());
+			return true;
+		};
+
+		TMap<ItemType, int32> NewIndices;
+		NewIndices.Reserve(New.Num());
+		for (int32 NewIndex = 0; NewIndex < New.Num(); ++NewIndex)
+		{
+			NewIndices.Add(New[NewIndex], NewIndex);
+		}
+		if (!ensureMsgf(NewIndices.Num() == New.Num(), TEXT("CollectionDiff::Compute: the new list repeats %d items"), New.Num() - NewIndices.Num()))
+		{
+			return EmitReset();
+		}
+
+		// Removals, back to front so earlier indices are unaffected by the edits before them.
+		for (int32 OldIndex = Old.Num() - 1; OldIndex >= 0;)
+		{
+			if (NewIndices.Contains(Old[OldIndex]))
+			{
+				--OldIndex;
+				continue;
+			}
+
+			const int32 RunLast = OldIndex;
+			while (OldIndex >= 0 && !NewIndices.Contains(Old[OldIndex]))
+			{
+				--OldIndex;
+			}
+			OutChanges.Emplace(EMolecularCollectionChange::Remove, OldIndex + 1, RunLast - OldIndex);
+			if (OutChanges.Num() > MaxChanges)
+			{
+				return EmitReset();
+			}
+		}
+
+		// The items left after the removals, in their old order, and where each of them ends up.
+		TArray<int32> SurvivorNewIndices;
+		SurvivorNewIndices.Reserve(Old.Num());
+		TArray<int32> SurvivorAtNewIndex;
+		SurvivorAtNewIndex.Init(INDEX_NONE, New.Num());
+		for (const ItemType& Item : Old)
+		{
+			if (const int32* NewIndex = NewIndices.Find(Item))
+			{
+				if (!ensureMsgf(SurvivorAtNewIndex[*NewIndex] == INDEX_NONE, TEXT("CollectionDiff::Compute: the old list repeats an item")))
+				{
+					return EmitReset();
+				}
+				SurvivorAtNewIndex[*NewIndex] = SurvivorNewIndices.Add(*NewIndex);
+			}
+		}
+		const int32 NumSurvivors = SurvivorNewIndices.Num();
+
+		int32 NumInsertRuns = 0;
+		for (int32 NewIndex = 0; NewIndex < New.Num(); ++NewIndex)
+		{
+			NumInsertRuns += SurvivorAtNewIndex[NewIndex] == INDEX_NONE && (NewIndex == 0 || SurvivorAtNewIndex[NewIndex - 1] != INDEX_NONE);
+		}
+
+		const TBitArray<> Stays = Private::LongestIncreasingSubsequence(SurvivorNewIndices);
+		const int32 NumMoves = NumSurvivors - Stays.CountSetBits();
+		if (OutChanges.Num() + NumMoves + NumInsertRuns > MaxChanges)
+		{
+			return EmitReset();
+		}
+
+		// Moves, in new order. Each moved item goes right after the survivor that precedes it in New, which has already
+		// found its place. That survivor is either one that stays, its anchor, or one moved right after it. So the list
+		// is ordered by (anchor, then new order) for moved items, with a staying or not yet moved item anchoring itself,
+		// and an item's position is the number of items ordered before it.
+		if (NumMoves > 0)
+		{
+			const int64 Stride = NumSurvivors + 2;
+			auto MakeKey = [Stride](const int32 Anchor, const int32 Order) { return (Anchor + 1) * Stride + Order; };
+
+			TArray<int64> Keys;
+			Keys.Reserve(NumSurvivors + NumMoves);
+			for (int32 Survivor = 0; Survivor < NumSurvivors; ++Survivor)
+			{
+				Keys.Add(MakeKey(Survivor, 0));
+			}
+			int32 Anchor = INDEX_NONE;
+			int32 Order = 0;
+			for (const int32 Survivor : SurvivorAtNewIndex)
+			{
+				if (Survivor != INDEX_NONE)
+				{
+					++Order;
+					if (Stays[Survivor])
+					{
+						Anchor = Survivor;
+					}
+					else
+					{
+						Keys.Add(MakeKey(Anchor, Order));
+					}
+				}
+			}
+			Algo::Sort(Keys);
+
+			Private::FSlotCounts Present(Keys.Num());
+			for (int32 Survivor = 0; Survivor < NumSurvivors; ++Survivor)
+			{
+				Present.Add(Algo::LowerBound(Keys, MakeKey(Survivor, 0)), 1);
+			}
+
+			Anchor = INDEX_NONE;
+			Order = 0;
+			for (const int32 Survivor : SurvivorAtNewIndex)
+			{
+				if (Survivor == INDEX_NONE)
+				{
+					continue;
+				}
+				++Order;
+				if (Stays[Survivor])
+				{
+					Anchor = Survivor;
+					continue;
+				}
+
+				const int32 FromSlot = Algo::LowerBound(Keys, MakeKey(Survivor, 0));
+				const int32 From = Present.CountBefore(FromSlot);
+				Present.Add(FromSlot, -1);
+				const int32 ToSlot = Algo::LowerBound(Keys, MakeKey(Anchor, Order));
+				const int32 To = Present.CountBefore(ToSlot);
+				Present.Add(ToSlot, 1);
+				if (From != To)
+				{
+					OutChanges.Emplace(EMolecularCollectionChange::Move, From, 1, To);
+				}
+			}
+		}
+
+		// Inserts, front to back. The survivors are in new order now, so everything before an insert already matches New.
+		for (int32 Target = 0; Target < New.Num();)
+		{
+			if (SurvivorAtNewIndex[Target] != INDEX_NONE)
+			{
+				++Target;
+				continue;
+			}
+
+			int32 RunEnd = Target;
+			while (RunEnd < New.Num() && SurvivorAtNewIndex[RunEnd] == INDEX_NONE)
+			{
+				++RunEnd;
+			}
+			OutChanges.Emplace(EMolecularCollectionChange::Insert, Target, RunEnd - Target);
+			Target = RunEnd;
+		}
+
+		return true;
+	}
+}
@@ -99,7 +99,7 @@ do \
 	* The macro provides flexibility with optional parameters to adjust failure likelihood and network delay.
 	* This can emulate various scenarios to assist debugging and fine-tuning UI behavior.
 	*
-	* @param TimerHandle The FTimerHandle member variable for this operation.
+	* @param TimerHandle The FTimerHandle for this call. Use a local one per call, so overlapping calls don't cancel each other.
 	* @param SuccessCallback A TFunction<void()> lambda to be called on success.
 	* @param FailureCallback A TFunction<void()> lambda to be called on failure.
 	* @param ... Optional parameters: FailureChance (float, default 0.0f), MinDelay (float, default 0.0f), MaxDelay (float, default 0.3f)
@@ -0,0 +1,79 @@
+// Copyright Mike Desrosiers, All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+
+#include <type_traits>
+
+namespace MolecularUI::RadixSort
+{
+	/** Maps a signed key to an unsigned one with the same ordering. */
+	inline uint32 SignedKey(const int32 Value)
+	{
+		return static_cast<uint32>(Value) ^ 0x80000000u;
+	}
+
+	/**
+	 * Stable LSD radix sort of Items by a 32-bit unsigned key, one byte per pass.
+	 *
+	 * Runs in linear time regardless of the key distribution. A pass is skipped when every key has the same digit in
+	 * it, so keys that fit in 16 bits (e.g. ranks in a catalog under 65536 items) only take two passes.
+	 *
+	 * @param Items The items to sort. Must be trivially copyable.
+	 * @param KeyFunc Returns the uint32 sort key of an item. Called once per item.
+	 */
+	template<typename ItemType, typename KeyFuncType>
+	void SortBy(TArray<ItemType>& Items, KeyFuncType&& KeyFunc)
+	{
+		static_assert(std::is_trivially_copyable_v<ItemType>, "RadixSort::SortBy: items are moved with raw copies.");
+
+		const int32 NumItems = Items.Num();
+		if (NumItems < 2)
+		{
+			return;
+		}
+
+		TArray<uint32> Keys;
+		Keys.SetNumUninitialized(NumItems);
+		for (int32 Index = 0; Index < NumItems; ++Index)
+		{
+			Keys[Index] = KeyFunc(Items[Index]);
+		}
+
+		TArray<ItemType> ScratchItems;
+		TArray<uint32> ScratchKeys;
+		ScratchItems.SetNumUninitialized(NumItems);
+		ScratchKeys.SetNumUninitialized(NumItems);
+
+		for (int32 Shift = 0; Shift < 32; Shift += 8)
+		{
+			int32 Offsets[256] = {};
+			for (const uint32 Key : Keys)
+			{
+				++Offsets[(Key >> Shift) & 0xFF];
+			}
+			if (Offsets[(Keys[0] >> Shift) & 0xFF] == NumItems)
+			{
+				continue; // Every key shares this digit, the pass would not move anything.
+			}
+
+			int32 Offset = 0;
+			for (int32& Count : Offsets)
+			{
+				const int32 DigitCount = Count;
+				Count = Offset;
+				Offset += DigitCount;
+			}
+
+			for (int32 Index = 0; Index < NumItems; ++Index)
+			{
+				const int32 Destination = Offsets[(Keys[Index] >> Shift) & 0xFF]++;
+				ScratchItems[Destination] = Items[Index];
+				ScratchKeys[Destination] = Keys[Index];
+			}
+			Swap(Items, ScratchItems);
+			Swap(Keys, ScratchKeys);
+		}
+	}
+}
@@ -0,0 +1,68 @@
+// Copyright Mike Desrosiers, All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+
+/**
+ * Rate limiter that allows bursts of up to Capacity actions, then one more every 1 / RefillPerSecond seconds.
+ * Time is passed in by the caller, so the bucket works with any clock and never reads one itself.
+ */
+struct FMolecularTokenBucket
+{
+	FMolecularTokenBucket() = default;
+
+	FMolecularTokenBucket(const int32 InCapacity, const double InRefillPerSecond)
+		: Capacity(FMath::Max(InCapacity, 1))
+		, RefillPerSecond(FMath::Max(InRefillPerSecond, 0.0))
+		, Tokens(Capacity)
+	{
+	}
+
+	/** Takes a token if one is available at Now. */
+	bool TryConsume(const double Now)
+	{
+		Refill(Now);
+		if (Tokens < 1.0)
+		{
+			return false;
+		}
+		Tokens -= 1.0;
+		return true;
+	}
+
+	/** Seconds from Now until TryConsume would succeed. Zero if a token is available, and MAX_dbl if the bucket never refills. */
+	double GetSecondsUntilNextToken(const double Now)
+	{
+		Refill(Now);
+		if (Tokens >= 1.0)
+		{
+			return 0.0;
+		}
+		return RefillPerSecond > 0.0 ? (1.0 - Tokens) / RefillPerSecond : MAX_dbl;
+	}
+
+	/** Fills the bucket back up, e.g. when the limits change. */
+	void Reset()
+	{
+		Tokens = Capacity;
+		LastRefillTime = -1.0;
+	}
+
+private:
+	void Refill(const double Now)
+	{
+		if (LastRefillTime >= 0.0 && Now > LastRefillTime)
+		{
+			Tokens = FMath::Min<double>(Capacity, Tokens + (Now - LastRefillTime) * RefillPerSecond);
+		}
+		LastRefillTime = FMath::Max(LastRefillTime, Now);
+	}
+
+	int32 Capacity = 1;
+	double RefillPerSecond = 1.0;
+	double Tokens = 1.0;
+
+	// Clock value of the last refill, or negative before the first one.
+	double LastRefillTime = -1.0;
+};
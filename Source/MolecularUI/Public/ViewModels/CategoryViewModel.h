@@ -15,11 +15,14 @@ class MOLECULARUI_API UCategoryViewModel : public UInteractiveViewModelBase
 	GENERATED_BODY()
 public:
 	void SetUIData(const FStandardUIData& InData) { UE_MVVM_SET_PROPERTY_VALUE(UIData, InData); }
-	FStandardUIData GetUIData() const { return UIData; }
+	const FStandardUIData& GetUIData() const { return UIData; }
 
 	void SetCategoryTag(const FGameplayTag& InTag) { UE_MVVM_SET_PROPERTY_VALUE(CategoryTag, InTag); }
 	FGameplayTag GetCategoryTag() const { return CategoryTag; }
 
+	void SetMatchCount(const int32 InMatchCount) { UE_MVVM_SET_PROPERTY_VALUE(MatchCount, InMatchCount); }
+	int32 GetMatchCount() const { return MatchCount; }
+
 	bool IsAll() const
 	{
 		return CategoryTag == MolecularUITags::Item::Category::All;
@@ -31,4 +34,8 @@ protected:
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, FieldNotify, Meta = (Categories = "Item.Category"))
 	FGameplayTag CategoryTag;
+
+	// Number of available items in this category that match the current filter text. Only maintained for categories shown as tabs.
+	UPROPERTY(BlueprintReadOnly, FieldNotify, Setter, Getter)
+	int32 MatchCount = 0;
 };
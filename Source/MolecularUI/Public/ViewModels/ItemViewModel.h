@@ -17,10 +17,10 @@ class MOLECULARUI_API UItemViewModel : public UInteractiveViewModelBase
 
 public:
 	void SetItemData(const FStoreItem& InItemData) { UE_MVVM_SET_PROPERTY_VALUE(ItemData, InItemData); }
-	FStoreItem GetItemData() const { return ItemData; }
+	const FStoreItem& GetItemData() const { return ItemData; }
 
 	void SetCategoryViewModels(const TArray<TObjectPtr<UCategoryViewModel>>& InCategories) { UE_MVVM_SET_PROPERTY_VALUE(CategoryViewModels, InCategories); }
-	TArray<TObjectPtr<UCategoryViewModel>> GetCategoryViewModels() const { return CategoryViewModels; }
+	const TArray<TObjectPtr<UCategoryViewModel>>& GetCategoryViewModels() const { return CategoryViewModels; }
 
 protected:
 	UPROPERTY(BlueprintReadWrite, FieldNotify, Category = "Item ViewModel | Data")
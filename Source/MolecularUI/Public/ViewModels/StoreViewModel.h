@@ -14,6 +14,8 @@
 class UCategoryViewModel;
 class UItemViewModel;
 
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnMolecularCollectionChanged, const FMolecularCollectionChangeSet& /*ChangeSet*/);
+
 UCLASS(Blueprintable, DisplayName = "Store ViewModel")
 class UStoreViewModel : public UMVVMViewModelBase
 {
@@ -29,32 +31,34 @@ public:
 
 	void AddCategory_AvailableItems(UCategoryViewModel* InCategory)
 	{
-		TArray<TObjectPtr<UCategoryViewModel>> NewCategories = CategoryTabs_AvailableItems;
-		if (!IsValid(InCategory))
-		{
-			return;
-		}
-		const TObjectPtr<UCategoryViewModel>* ExistingCategory =
-			Algo::FindByPredicate(NewCategories, [InCategory](const TObjectPtr<UCategoryViewModel>& Category)
-				{ return Category->GetCategoryTag() == InCategory->GetCategoryTag(); });
-		if (ExistingCategory)
-		{
-			return; // Category already exists, no need to add it again.
-		}
-		NewCategories.Add(InCategory);
-		SetCategoryTabs_AvailableItems(NewCategories);
+		AddCategories_AvailableItems(MakeArrayView(&InCategory, 1));
 	}
+	// Appends the categories whose tag has no tab yet, in order, with a single broadcast for the whole batch.
+	void AddCategories_AvailableItems(TConstArrayView<UCategoryViewModel*> InCategories);
 	void SetCategoryTabs_AvailableItems(const TArray<UCategoryViewModel*>& InCategories) { UE_MVVM_SET_PROPERTY_VALUE(CategoryTabs_AvailableItems, InCategories); }
 	const TArray<TObjectPtr<UCategoryViewModel>>& GetCategoryTabs_AvailableItems() const { return CategoryTabs_AvailableItems; }
 
 	void SetTransactionType(const ETransactionType InType) { UE_MVVM_SET_PROPERTY_VALUE(TransactionType, InType); }
 	ETransactionType GetTransactionType() const { return TransactionType; }
 
-	void SetAvailableItems(const TArray<TObjectPtr<UItemViewModel>>& InItems) { UE_MVVM_SET_PROPERTY_VALUE(AvailableItems, InItems); }
+	/**
+	 * Replacing an item list also publishes the edits between the old and new contents on its change channel.
+	 * Every update notifies the list field first, then the change channel, then the native delegate, so a handler of
+	 * either signal reads the new list. A view binds one signal per list: the list field to rebuild its rows on every
+	 * update, or the change channel to patch only the affected rows. A view bound to both does the work twice.
+	 */
+	void SetAvailableItems(const TArray<TObjectPtr<UItemViewModel>>& InItems);
 	const TArray<TObjectPtr<UItemViewModel>>& GetAvailableItems() const { return AvailableItems; }
+	const FMolecularCollectionChangeSet& GetAvailableItemsChanges() const { return AvailableItemsChanges; }
 
-	void SetOwnedItems(const TArray<TObjectPtr<UItemViewModel>>& InItems) { UE_MVVM_SET_PROPERTY_VALUE(OwnedItems, InItems); }
+	void SetOwnedItems(const TArray<TObjectPtr<UItemViewModel>>& InItems);
 	const TArray<TObjectPtr<UItemViewModel>>& GetOwnedItems() const { return OwnedItems; }
+	const FMolecularCollectionChangeSet& GetOwnedItemsChanges() const { return OwnedItemsChanges; }
+
+	// Native listeners for the change channels, broadcast after the item list has been updated. Same signal as the
+	// change channel fields, for views that aren't bound through MVVM.
+	FOnMolecularCollectionChanged OnAvailableItemsChanged;
+	FOnMolecularCollectionChanged OnOwnedItemsChanged;
 
 	void SetStoreStates(const FGameplayTagContainer& InStates) { UE_MVVM_SET_PROPERTY_VALUE(StoreStates, InStates); }
 	const FGameplayTagContainer& GetStoreStates() const { return StoreStates; }
@@ -87,6 +91,21 @@ public:
 	void SetFilterText(const FString& InFilterText) { UE_MVVM_SET_PROPERTY_VALUE(FilterText, InFilterText); }
 	FString GetFilterText() const { return FilterText; }
 
+	void SetMinCostFilter(const int32 InMinCost) { UE_MVVM_SET_PROPERTY_VALUE(MinCostFilter, InMinCost); }
+	int32 GetMinCostFilter() const { return MinCostFilter; }
+
+	void SetMaxCostFilter(const int32 InMaxCost) { UE_MVVM_SET_PROPERTY_VALUE(MaxCostFilter, InMaxCost); }
+	int32 GetMaxCostFilter() const { return MaxCostFilter; }
+
+	void SetCostHistogram(const FStoreCostHistogram& InHistogram) { UE_MVVM_SET_PROPERTY_VALUE(CostHistogram, InHistogram); }
+	const FStoreCostHistogram& GetCostHistogram() const { return CostHistogram; }
+
+	void SetSearchMode(const EStoreSearchMode InSearchMode) { UE_MVVM_SET_PROPERTY_VALUE(SearchMode, InSearchMode); }
+	EStoreSearchMode GetSearchMode() const { return SearchMode; }
+
+	void SetSortMode(const FStoreSortMode& InSortMode) { UE_MVVM_SET_PROPERTY_VALUE(SortMode, InSortMode); }
+	const FStoreSortMode& GetSortMode() const { return SortMode; }
+
 	UFUNCTION(BlueprintCallable, Category = "Store ViewModel")
 	void SetRefreshRequested(const bool bInRefreshRequested) { UE_MVVM_SET_PROPERTY_VALUE(bRefreshRequested, bInRefreshRequested); }
 	UFUNCTION(BlueprintPure, Category = "Store ViewModel")
@@ -108,6 +127,18 @@ protected:
 
 	UPROPERTY(BlueprintReadWrite, FieldNotify, Setter, Getter, Category = "Store ViewModel")
 	TArray<TObjectPtr<UItemViewModel>> OwnedItems;
+
+	// Change channels for the item lists. Bind these instead of the lists, not as well, to patch only the affected rows.
+	// A Reset change set means the list changed too much to describe, and the view rebuilds from the list.
+	UPROPERTY(BlueprintReadOnly, FieldNotify, Getter, Category = "Store ViewModel")
+	FMolecularCollectionChangeSet AvailableItemsChanges;
+
+	UPROPERTY(BlueprintReadOnly, FieldNotify, Getter, Category = "Store ViewModel")
+	FMolecularCollectionChangeSet OwnedItemsChanges;
+
+	// Costs of the items available for purchase, computed once per catalog load.
+	UPROPERTY(BlueprintReadOnly, FieldNotify, Getter, Category = "Store ViewModel")
+	FStoreCostHistogram CostHistogram;
 	
 	UPROPERTY(BlueprintReadWrite, FieldNotify, Getter, Category = "Store ViewModel")
 	TArray<TObjectPtr<UCategoryViewModel>> CategoryTabs_AvailableItems;
@@ -133,9 +164,26 @@ protected:
 	UPROPERTY(BlueprintReadWrite, FieldNotify, Setter, Getter, Category = "Store ViewModel | Intent")
 	FString FilterText;
 
+	// Inclusive cost bounds of the available items list. The defaults leave it unbounded.
+	UPROPERTY(BlueprintReadWrite, FieldNotify, Setter, Getter, Category = "Store ViewModel | Intent")
+	int32 MinCostFilter = 0;
+
+	UPROPERTY(BlueprintReadWrite, FieldNotify, Setter, Getter, Category = "Store ViewModel | Intent")
+	int32 MaxCostFilter = MAX_int32;
+
+	// How FilterText is matched. Fuzzy results are ordered by score and ignore SortMode.
+	UPROPERTY(BlueprintReadWrite, FieldNotify, Setter, Getter, Category = "Store ViewModel | Intent")
+	EStoreSearchMode SearchMode = EStoreSearchMode::Substring;
+
+	// Order of the available items list.
+	UPROPERTY(BlueprintReadWrite, FieldNotify, Setter, Getter, Category = "Store ViewModel | Intent")
+	FStoreSortMode SortMode;
+
 	UPROPERTY(BlueprintReadWrite, FieldNotify, Setter = "SetRefreshRequested", Getter = "GetRefreshRequested", Category = "Store ViewModel | Intent")
 	bool bRefreshRequested = false;
-	
 
+private:
+	// Diffs InItems against Items, then stores InItems and the resulting edits. Returns false if nothing changed.
+	static bool UpdateItemList(TArray<TObjectPtr<UItemViewModel>>& Items, const TArray<TObjectPtr<UItemViewModel>>& InItems, FMolecularCollectionChangeSet& OutChangeSet);
 };
 
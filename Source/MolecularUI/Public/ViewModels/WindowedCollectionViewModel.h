@@ -0,0 +1,68 @@
+// Copyright Mike Desrosiers, All Rights Reserved.
+
+#pragma once
+
+#include <CoreMinimal.h>
+#include <MVVMViewModelBase.h>
+
+#include "MolecularTypes.h"
+#include "WindowedCollectionViewModel.generated.h"
+
+/*
+ * A ViewModel that exposes only a window of a potentially very large list.
+ *
+ * The view reports what it is showing through VisibleRange. The model answers with the entries of that range plus
+ * PrefetchMargin entries on either side, and with the full TotalCount so a scrollbar can be sized without the
+ * rest of the list existing as ViewModels.
+ */
+UCLASS(Blueprintable, DisplayName = "Windowed Collection ViewModel")
+class MOLECULARUI_API UWindowedCollectionViewModel : public UMVVMViewModelBase
+{
+	GENERATED_BODY()
+
+public:
+	// Intent: called by the view whenever the visible entries or the scroll position change.
+	UFUNCTION(BlueprintCallable, Category = "Windowed Collection ViewModel | Intent")
+	void SetVisibleRange(const FMolecularVisibleRange& InRange) { UE_MVVM_SET_PROPERTY_VALUE(VisibleRange, InRange); }
+	const FMolecularVisibleRange& GetVisibleRange() const { return VisibleRange; }
+
+	void SetTotalCount(const int32 InTotalCount) { UE_MVVM_SET_PROPERTY_VALUE(TotalCount, InTotalCount); }
+	int32 GetTotalCount() const { return TotalCount; }
+
+	// Replaces the window contents. InItems[0] is the entry at InStartIndex in the full list.
+	void SetWindow(const int32 InStartIndex, const TArray<TObjectPtr<UMVVMViewModelBase>>& InItems);
+	int32 GetWindowStartIndex() const { return WindowStartIndex; }
+	const TArray<TObjectPtr<UMVVMViewModelBase>>& GetWindowItems() const { return WindowItems; }
+
+	int32 GetPrefetchMargin() const { return PrefetchMargin; }
+
+	/** Returns the entry at an index of the full list, or null if it lies outside the current window. */
+	UFUNCTION(BlueprintPure, Category = "Windowed Collection ViewModel")
+	UMVVMViewModelBase* GetItemAt(const int32 Index) const;
+
+	/** Computes the [OutStart, OutEnd) range of the full list the model should supply for the current visible range. */
+	void GetRequestedWindow(int32& OutStart, int32& OutEnd) const;
+
+	/** True if every visible entry is already inside the current window. */
+	bool IsVisibleRangeLoaded() const;
+
+protected:
+	// Entries supplied beyond each edge of the visible range, so short scrolls don't need a new window.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Windowed Collection ViewModel", meta = (ClampMin = 0))
+	int32 PrefetchMargin = 20;
+
+	// Size of the full list.
+	UPROPERTY(BlueprintReadOnly, FieldNotify, Getter, Category = "Windowed Collection ViewModel")
+	int32 TotalCount = 0;
+
+	// Index in the full list of the first entry in WindowItems.
+	UPROPERTY(BlueprintReadOnly, FieldNotify, Getter, Category = "Windowed Collection ViewModel")
+	int32 WindowStartIndex = 0;
+
+	UPROPERTY(BlueprintReadOnly, FieldNotify, Getter, Category = "Windowed Collection ViewModel")
+	TArray<TObjectPtr<UMVVMViewModelBase>> WindowItems;
+
+	/* Intent Channel */
+	UPROPERTY(BlueprintReadWrite, FieldNotify, Setter, Getter, Category = "Windowed Collection ViewModel | Intent")
+	FMolecularVisibleRange VisibleRange;
+};